@@ -149,6 +149,79 @@ static IOR_offset_t DUMMY_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer
   return length;
 }
 
+/*
+ * Asynchronous transfers complete delay-xfer usec after their submission,
+ * i.e., the delays of transfers in flight overlap.
+ */
+typedef struct {
+  void * tag;
+  IOR_offset_t length;
+  double deadline;
+} dummy_request_t;
+
+static dummy_request_t * requests = NULL;
+static int requests_count = 0;
+static int requests_size = 0;
+
+static int DUMMY_Xfer_submit(int access, aiori_fd_t *file, IOR_size_t * buffer, IOR_offset_t length, IOR_offset_t offset, void * tag, aiori_mod_opt_t * options){
+  if(verbose > 4){
+    fprintf(out_logfile, "DUMMY xfer submit: %p\n", file);
+  }
+  dummy_options_t * o = (dummy_options_t*) options;
+  if(requests_count == requests_size){
+    requests_size = requests_size == 0 ? 16 : requests_size * 2;
+    requests = realloc(requests, sizeof(dummy_request_t) * requests_size);
+    if(requests == NULL){
+      ERR("DUMMY cannot allocate requests");
+    }
+  }
+  dummy_request_t * r = & requests[requests_count++];
+  r->tag = tag;
+  r->length = length;
+  r->deadline = GetTimeStamp();
+  if (o->delay_xfer){
+    if (! o->delay_rank_0_only || (o->delay_rank_0_only && rank == 0)){
+      r->deadline += o->delay_xfer * 1e-6;
+    }
+  }
+  return 0;
+}
+
+static int DUMMY_Xfer_poll(aiori_fd_t *file, aiori_xfer_completion_t * completions, int max, aiori_mod_opt_t * options){
+  double now = GetTimeStamp();
+  int count = 0;
+  for(int i = 0; i < requests_count && count < max; ){
+    if(requests[i].deadline <= now){
+      completions[count].tag = requests[i].tag;
+      completions[count].amount = requests[i].length;
+      count++;
+      requests[i] = requests[--requests_count];
+    }else{
+      i++;
+    }
+  }
+  return count;
+}
+
+static int DUMMY_Xfer_wait(aiori_fd_t *file, aiori_xfer_completion_t * completions, int min, int max, aiori_mod_opt_t * options){
+  int count = DUMMY_Xfer_poll(file, completions, max, options);
+  while(count < min && requests_count > 0){
+    double earliest = requests[0].deadline;
+    for(int i = 1; i < requests_count; i++){
+      if(requests[i].deadline < earliest){
+        earliest = requests[i].deadline;
+      }
+    }
+    double delay = earliest - GetTimeStamp();
+    if(delay > 0){
+      struct timespec wait = {(time_t) delay, (long) ((delay - (time_t) delay) * 1e9)};
+      nanosleep( & wait, NULL);
+    }
+    count += DUMMY_Xfer_poll(file, completions + count, max - count, options);
+  }
+  return count;
+}
+
 static int DUMMY_statfs (const char * path, ior_aiori_statfs_t * stat, aiori_mod_opt_t * options){
   stat->f_bsize = 1;
   stat->f_blocks = 1;
@@ -219,6 +292,9 @@ ior_aiori_t dummy_aiori = {
         .create = DUMMY_Create,
         .open = DUMMY_Open,
         .xfer = DUMMY_Xfer,
+        .xfer_submit = DUMMY_Xfer_submit,
+        .xfer_poll = DUMMY_Xfer_poll,
+        .xfer_wait = DUMMY_Xfer_wait,
         .close = DUMMY_Close,
         .remove = DUMMY_Delete,
         .get_version = DUMMY_getVersion,
@@ -235,5 +311,6 @@ ior_aiori_t dummy_aiori = {
         .get_options = DUMMY_options,
         .check_params = DUMMY_check_params,
         .sync = DUMMY_Sync,
-        .enable_mdtest = true
+        .enable_mdtest = true,
+        .thread_safe = true
 };
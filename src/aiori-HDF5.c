@@ -88,6 +88,7 @@ static aiori_fd_t *HDF5_Create(char *, int flags, aiori_mod_opt_t *);
 static aiori_fd_t *HDF5_Open(char *, int flags, aiori_mod_opt_t *);
 static IOR_offset_t HDF5_Xfer(int, aiori_fd_t *, IOR_size_t *,
                               IOR_offset_t, IOR_offset_t, aiori_mod_opt_t *);
+static IOR_offset_t HDF5_Xferv(int, aiori_fd_t *, aiori_xfer_extent_t *, int, aiori_mod_opt_t *);
 static void HDF5_Close(aiori_fd_t *, aiori_mod_opt_t *);
 static void HDF5_Delete(char *, aiori_mod_opt_t *);
 static char* HDF5_GetVersion();
@@ -156,6 +157,7 @@ ior_aiori_t hdf5_aiori = {
         .create = HDF5_Create,
         .open = HDF5_Open,
         .xfer = HDF5_Xfer,
+        .xferv = HDF5_Xferv,
         .close = HDF5_Close,
         .remove = HDF5_Delete,
         .get_version = HDF5_GetVersion,
@@ -195,6 +197,16 @@ static void HDF5_init_xfer_options(aiori_xfer_hint_t * params){
   MPIIO_xfer_hints(params);
 }
 
+/*
+ * Returns the size of a block in the data set, with extentSize the holes
+ * between the extents are part of it.
+ */
+static IOR_offset_t DataSetBlockSize(void){
+  if (hints->extentSize > 0)
+    return hints->blockSize / hints->extentSize * (hints->extentSize + hints->fileHole);
+  return hints->blockSize;
+}
+
 static int HDF5_check_params(aiori_mod_opt_t * options){
   HDF5_options_t *o = (HDF5_options_t*) options;
   if (o->setAlignment < 0)
@@ -385,7 +397,7 @@ static aiori_fd_t *HDF5_Open(char *testFileName, int flags, aiori_mod_opt_t * pa
                         tasksPerDataSet = hints->numTasks;
                 }
         }
-        dataSetDims[0] = (hsize_t) ((hints->blockSize / sizeof(IOR_size_t))
+        dataSetDims[0] = (hsize_t) ((DataSetBlockSize() / sizeof(IOR_size_t))
                                     * tasksPerDataSet);
 
         /* create a simple data space containing information on size
@@ -399,13 +411,12 @@ static aiori_fd_t *HDF5_Open(char *testFileName, int flags, aiori_mod_opt_t * pa
 }
 
 /*
- * Write or read access to file using the HDF5 interface.
+ * Open or create the data set of the segment at its first transfer.
  */
-static IOR_offset_t HDF5_Xfer(int access, aiori_fd_t *afd, IOR_size_t * buffer,
-                              IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param)
+static void StartDataSet(aiori_h5fd_t * fd, int access, IOR_offset_t offset, aiori_mod_opt_t * param)
 {
         IOR_offset_t segmentPosition, segmentSize;
-        aiori_h5fd_t * fd = (aiori_h5fd_t *) afd;
+        IOR_offset_t blockSize = DataSetBlockSize();
 
         /*
          * this toggle is for the read check operation, which passes through
@@ -423,12 +434,12 @@ static IOR_offset_t HDF5_Xfer(int access, aiori_fd_t *afd, IOR_size_t * buffer,
         /* determine by offset if need to start new data set */
         if (hints->filePerProc == TRUE) {
                 segmentPosition = (IOR_offset_t) 0;
-                segmentSize = hints->blockSize;
+                segmentSize = blockSize;
         } else {
                 segmentPosition =
                     (IOR_offset_t) ((rank + rankOffset) % hints->numTasks)
-                    * hints->blockSize;
-                segmentSize = (IOR_offset_t) (hints->numTasks) * hints->blockSize;
+                    * blockSize;
+                segmentSize = (IOR_offset_t) (hints->numTasks) * blockSize;
         }
         if ((IOR_offset_t) ((offset - segmentPosition) % segmentSize) ==
             0) {
@@ -443,7 +454,7 @@ static IOR_offset_t HDF5_Xfer(int access, aiori_fd_t *afd, IOR_size_t * buffer,
         }
 
         if(hints->dryRun)
-          return length;
+          return;
 
         /* create new data set */
         if (fd->startNewDataSet == TRUE) {
@@ -456,11 +467,24 @@ static IOR_offset_t HDF5_Xfer(int access, aiori_fd_t *afd, IOR_size_t * buffer,
                 SetupDataSet(fd, access == WRITE ? IOR_CREAT : IOR_RDWR, param);
         }
 
-        SeekOffset(fd, offset, param);
-
         /* this is necessary to reset variables for reaccessing file */
         fd->startNewDataSet = FALSE;
         fd->newlyOpenedFile = FALSE;
+}
+
+/*
+ * Write or read access to file using the HDF5 interface.
+ */
+static IOR_offset_t HDF5_Xfer(int access, aiori_fd_t *afd, IOR_size_t * buffer,
+                              IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param)
+{
+        aiori_h5fd_t * fd = (aiori_h5fd_t *) afd;
+
+        StartDataSet(fd, access, offset, param);
+        if(hints->dryRun)
+          return length;
+
+        SeekOffset(fd, offset, param);
 
         /* access the file */
         if (access == WRITE) {  /* WRITE */
@@ -477,6 +501,66 @@ static IOR_offset_t HDF5_Xfer(int access, aiori_fd_t *afd, IOR_size_t * buffer,
         return (length);
 }
 
+/*
+ * Vectored access, the extents are selected as a union of hyperslabs in the
+ * file data space and in a memory data space that spans all buffers, thus a
+ * single H5Dwrite()/H5Dread() accesses them.
+ */
+static IOR_offset_t HDF5_Xferv(int access, aiori_fd_t *afd, aiori_xfer_extent_t * extents,
+                               int count, aiori_mod_opt_t * param)
+{
+        aiori_h5fd_t * fd = (aiori_h5fd_t *) afd;
+        HDF5_options_t *o = (HDF5_options_t*) param;
+        char * base = (char *) extents[0].buffer;
+        IOR_offset_t total = 0;
+        IOR_offset_t segmentSize;
+        hsize_t hsStart[NUM_DIMS], hsCount[NUM_DIMS], hsBlock[NUM_DIMS];
+        hsize_t memDims[NUM_DIMS];
+        hid_t memDataSpace;
+
+        for (int i = 0; i < count; i++)
+                total += extents[i].length;
+
+        StartDataSet(fd, access, extents[0].offset, param);
+        if(hints->dryRun)
+          return total;
+
+        if (o->individualDataSets || hints->filePerProc) {
+                segmentSize = DataSetBlockSize();
+        } else {
+                segmentSize = (IOR_offset_t) (hints->numTasks) * DataSetBlockSize();
+        }
+        memDims[0] = (hsize_t) (((char *) extents[count - 1].buffer - base + extents[count - 1].length) / sizeof(IOR_size_t));
+        memDataSpace = H5Screate_simple(NUM_DIMS, memDims, NULL);
+        HDF5_CHECK(memDataSpace, "cannot create simple memory data space");
+        HDF5_CHECK(H5Sselect_none(memDataSpace), "cannot reset selection");
+        HDF5_CHECK(H5Sselect_none(fd->fileDataSpace), "cannot reset selection");
+        hsCount[0] = (hsize_t) 1;
+        for (int i = 0; i < count; i++) {
+                hsBlock[0] = (hsize_t) (extents[i].length / sizeof(IOR_size_t));
+                hsStart[0] = (hsize_t) ((extents[i].offset % segmentSize) / sizeof(IOR_size_t));
+                HDF5_CHECK(H5Sselect_hyperslab(fd->fileDataSpace, H5S_SELECT_OR, hsStart, NULL, hsCount, hsBlock),
+                           "cannot select hyperslab");
+                hsStart[0] = (hsize_t) (((char *) extents[i].buffer - base) / sizeof(IOR_size_t));
+                HDF5_CHECK(H5Sselect_hyperslab(memDataSpace, H5S_SELECT_OR, hsStart, NULL, hsCount, hsBlock),
+                           "cannot select hyperslab");
+        }
+
+        if (access == WRITE) {
+                HDF5_CHECK(H5Dwrite(fd->dataSet, H5T_NATIVE_LLONG,
+                                    memDataSpace, fd->fileDataSpace,
+                                    fd->xferPropList, base),
+                           "cannot write to data set");
+        } else {
+                HDF5_CHECK(H5Dread(fd->dataSet, H5T_NATIVE_LLONG,
+                                   memDataSpace, fd->fileDataSpace,
+                                   fd->xferPropList, base),
+                           "cannot read from data set");
+        }
+        HDF5_CHECK(H5Sclose(memDataSpace), "cannot close memory data space");
+        return total;
+}
+
 /*
  * Perform fsync().
  */
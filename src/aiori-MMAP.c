@@ -11,6 +11,10 @@
 #  include "config.h"
 #endif
 
+#ifdef __linux__
+#  define _DEFAULT_SOURCE         /* MAP_POPULATE and MADV_HUGEPAGE */
+#endif                          /* __linux__ */
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -19,6 +23,7 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "ior.h"
 #include "aiori.h"
@@ -45,23 +50,41 @@ ior_aiori_t mmap_aiori = {
         .xfer = MMAP_Xfer,
         .close = MMAP_Close,
         .remove = POSIX_Delete,
+        .cache_control = POSIX_CacheControl,
+        .cache_residency = POSIX_CacheResidency,
         .xfer_hints = MMAP_xfer_hints,
         .get_version = aiori_get_version,
         .fsync = MMAP_Fsync,
         .get_file_size = POSIX_GetFileSize,
         .get_options = MMAP_options,
-        .check_params = MMAP_check_params
+        .check_params = MMAP_check_params,
+        .thread_safe = true
 };
 
 /***************************** F U N C T I O N S ******************************/
 typedef struct{
-  int direct_io_ignored; /* this option is ignored */
-  void* mmap_ptr; /* for internal usage */
+  aiori_mod_opt_t * p; /* the options of the POSIX backend used to open the files */
+  long long window; /* bytes mapped at a time, 0 for the block size */
+  int populate; /* prefault the pages of every mapping */
+  int hugepages; /* use transparent huge pages for the mappings */
 
   int madv_dont_need;
   int madv_pattern;
 } mmap_options_t;
 
+/* a file with the window of it that is currently mapped */
+typedef struct{
+  aiori_fd_t * pfd; /* the underlying POSIX fd */
+  int prot; /* protection of the mappings */
+  IOR_offset_t size; /* size of the file */
+  char * map; /* mapped window, NULL if none */
+  IOR_offset_t map_offset;
+  IOR_offset_t map_length;
+  pthread_rwlock_t lock; /* threads copy under the read lock, remap under the write lock */
+} mmap_fd_t;
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 static option_help * MMAP_options(aiori_mod_opt_t ** init_backend_options, aiori_mod_opt_t * init_values){
   mmap_options_t * o = malloc(sizeof(mmap_options_t));
 
@@ -70,16 +93,20 @@ static option_help * MMAP_options(aiori_mod_opt_t ** init_backend_options, aiori
   }else{
     memset(o, 0, sizeof(mmap_options_t));
   }
+  option_help * p_help = POSIX_options(& o->p, init_values == NULL ? NULL : ((mmap_options_t*)init_values)->p);
 
   *init_backend_options = (aiori_mod_opt_t*) o;
 
   option_help h [] = {
     {0, "mmap.madv_dont_need", "Use advise don't need", OPTION_FLAG, 'd', & o->madv_dont_need},
     {0, "mmap.madv_pattern", "Use advise to indicate the pattern random/sequential", OPTION_FLAG, 'd', & o->madv_pattern},
+    {0, "mmap.window", "Bytes of the file mapped at a time, the window slides to the accessed data, 0 maps one block at a time", OPTION_OPTIONAL_ARGUMENT, 'l', & o->window},
+    {0, "mmap.populate", "Prefault the pages of every mapping (MAP_POPULATE)", OPTION_FLAG, 'd', & o->populate},
+    {0, "mmap.hugepages", "Align the mappings to 2 MiB and advise huge pages (MADV_HUGEPAGE)", OPTION_FLAG, 'd', & o->hugepages},
     LAST_OPTION
   };
-  option_help * help = malloc(sizeof(h));
-  memcpy(help, h, sizeof(h));
+  option_help * help = option_merge(h, p_help);
+  free(p_help);
   return help;
 }
 
@@ -91,41 +118,118 @@ static void MMAP_xfer_hints(aiori_xfer_hint_t * params){
 }
 
 static int MMAP_check_params(aiori_mod_opt_t * options){
+  mmap_options_t * o = (mmap_options_t*) options;
+  POSIX_check_params(o->p);
   if (hints->fsyncPerWrite && (hints->transferSize & (sysconf(_SC_PAGESIZE) - 1)))
     ERR("transfer size must be aligned with PAGESIZE for MMAP with fsyncPerWrite");
+  if (o->window < 0)
+    ERR("mmap.window must be >= 0");
+#ifndef MAP_POPULATE
+  if (o->populate)
+    ERR("mmap.populate requires MAP_POPULATE which is not available");
+#endif
+#ifndef MADV_HUGEPAGE
+  if (o->hugepages)
+    ERR("mmap.hugepages requires MADV_HUGEPAGE which is not available");
+#endif
   return 0;
 }
 
-static void ior_mmap_file(int *file, int mflags, void *param)
+/*
+ * The size of one file, the aggregate size split between the files.
+ */
+static IOR_offset_t MMAP_FileSize(void)
+{
+        if (hints->filePerProc)
+                return hints->expectedAggFileSize / hints->numTasks;
+        if (hints->ranksPerFile > 1)
+                return hints->expectedAggFileSize / (hints->numTasks / hints->ranksPerFile);
+        return hints->expectedAggFileSize;
+}
+
+/*
+ * Size of the window, a multiple of the page size.
+ */
+static IOR_offset_t MMAP_WindowSize(mmap_options_t * o)
+{
+        IOR_offset_t page = o->hugepages ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+        IOR_offset_t window = o->window > 0 ? o->window : hints->blockSize;
+        return (window + page - 1) / page * page;
+}
+
+static aiori_fd_t *ior_mmap_file(aiori_fd_t * pfd, int mflags, mmap_options_t * o)
 {
-        int flags = PROT_READ;
-        IOR_offset_t size = hints->expectedAggFileSize;
+        mmap_fd_t * mfd = safeMalloc(sizeof(mmap_fd_t));
+        int fd = *(int *) pfd;
+        struct stat st;
 
+        mfd->pfd = pfd;
+        mfd->prot = PROT_READ;
         if (mflags & IOR_WRONLY || mflags & IOR_RDWR)
-                flags |= PROT_WRITE;
-        mmap_options_t *o = (mmap_options_t*) param;
+                mfd->prot |= PROT_WRITE;
+        mfd->map = NULL;
+        mfd->map_offset = 0;
+        mfd->map_length = 0;
+        if (fstat(fd, & st) != 0)
+                ERRF("fstat() failed: %s", strerror(errno));
+        mfd->size = st.st_size;
+        /* the mapped file must be large enough for the writes */
+        if ((mfd->prot & PROT_WRITE) && mfd->size < MMAP_FileSize()) {
+                if (ftruncate(fd, MMAP_FileSize()) != 0)
+                        ERR("ftruncate() failed");
+                mfd->size = MMAP_FileSize();
+        }
+        if (pthread_rwlock_init(& mfd->lock, NULL) != 0)
+                ERR("pthread_rwlock_init() failed");
+        return (aiori_fd_t *) mfd;
+}
 
-        o->mmap_ptr = mmap(NULL, size, flags, MAP_SHARED,
-                               *file, 0);
-        if (o->mmap_ptr == MAP_FAILED)
-                ERR("mmap() failed");
+/*
+ * Map the window of the file holding [offset, offset + length), the window
+ * starts at a multiple of its size and is extended for transfers crossing it.
+ * Returns -1 if the range is beyond the end of the file.
+ */
+static int MMAP_Window(mmap_fd_t * mfd, IOR_offset_t offset, IOR_offset_t length, mmap_options_t * o)
+{
+        IOR_offset_t window = MMAP_WindowSize(o);
+        IOR_offset_t page = o->hugepages ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+        IOR_offset_t start = offset - offset % window;
+        IOR_offset_t end = start + window;
+        int flags = MAP_SHARED;
 
-        if (hints->randomOffset)
-                flags = POSIX_MADV_RANDOM;
-        else
-                flags = POSIX_MADV_SEQUENTIAL;
+        if (offset + length > mfd->size)
+                return -1;
+        if (offset + length > end)
+                end = (offset + length + page - 1) / page * page;
+        if (end > mfd->size)
+                end = mfd->size;
+        if (mfd->map != NULL && munmap(mfd->map, mfd->map_length) != 0)
+                ERRF("munmap() failed: %s", strerror(errno));
+        mfd->map = NULL;
+#ifdef MAP_POPULATE
+        if (o->populate)
+                flags |= MAP_POPULATE;
+#endif
+        void * map = mmap(NULL, end - start, mfd->prot, flags, *(int *) mfd->pfd, start);
+        if (map == MAP_FAILED)
+                ERRF("mmap() of %lld bytes at offset %lld failed: %s", end - start, start, strerror(errno));
+        mfd->map = map;
+        mfd->map_offset = start;
+        mfd->map_length = end - start;
 
-        if(o->madv_pattern){
-          if (posix_madvise(o->mmap_ptr, size, flags) != 0)
-          ERR("madvise() failed");
+#ifdef MADV_HUGEPAGE
+        if (o->hugepages && madvise(mfd->map, mfd->map_length, MADV_HUGEPAGE) != 0)
+                WARNF("madvise(MADV_HUGEPAGE) failed: %s", strerror(errno));
+#endif
+        if (o->madv_pattern) {
+                if (posix_madvise(mfd->map, mfd->map_length, hints->randomOffset ? POSIX_MADV_RANDOM : POSIX_MADV_SEQUENTIAL) != 0)
+                        ERR("madvise() failed");
         }
-
-        if (o->madv_dont_need){
-          if (posix_madvise(o->mmap_ptr, size, POSIX_MADV_DONTNEED) != 0)
-          ERR("madvise() failed");
+        if (o->madv_dont_need) {
+                if (posix_madvise(mfd->map, mfd->map_length, POSIX_MADV_DONTNEED) != 0)
+                        ERR("madvise() failed");
         }
-
-        return;
+        return 0;
 }
 
 /*
@@ -133,13 +237,9 @@ static void ior_mmap_file(int *file, int mflags, void *param)
  */
 static aiori_fd_t *MMAP_Create(char *testFileName, int flags, aiori_mod_opt_t * param)
 {
-        int *fd;
-
-        fd = (int*) POSIX_Create(testFileName, flags, param);
-        if (ftruncate(*fd, hints->expectedAggFileSize) != 0)
-                ERR("ftruncate() failed");
-        ior_mmap_file(fd, flags, param);
-        return ((aiori_fd_t *)fd);
+        mmap_options_t *o = (mmap_options_t*) param;
+        aiori_fd_t * pfd = POSIX_Create(testFileName, flags, o->p);
+        return ior_mmap_file(pfd, flags, o);
 }
 
 /*
@@ -147,43 +247,71 @@ static aiori_fd_t *MMAP_Create(char *testFileName, int flags, aiori_mod_opt_t *
  */
 static aiori_fd_t *MMAP_Open(char *testFileName, int flags, aiori_mod_opt_t * param)
 {
-        int *fd;
-        fd = (int*) POSIX_Open(testFileName, flags, param);
-        ior_mmap_file(fd, flags, param);
-        return ((aiori_fd_t *)fd);
+        mmap_options_t *o = (mmap_options_t*) param;
+        aiori_fd_t * pfd = POSIX_Open(testFileName, flags, o->p);
+        return ior_mmap_file(pfd, flags, o);
 }
 
-/*
- * Write or read access to file using mmap
- */
-static IOR_offset_t MMAP_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer,
-                               IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param)
+static void MMAP_Copy(int access, mmap_fd_t * mfd, IOR_size_t * buffer,
+                      IOR_offset_t length, IOR_offset_t offset)
 {
-        mmap_options_t *o = (mmap_options_t*) param;
+        char * ptr = mfd->map + (offset - mfd->map_offset);
         if (access == WRITE) {
-                memcpy(o->mmap_ptr + offset, buffer, length);
+                memcpy(ptr, buffer, length);
         } else {
-                memcpy(buffer, o->mmap_ptr + offset, length);
+                memcpy(buffer, ptr, length);
         }
 
         if (hints->fsyncPerWrite == TRUE) {
-                if (msync(o->mmap_ptr + offset, length, MS_SYNC) != 0)
+                if (msync(ptr, length, MS_SYNC) != 0)
                         ERR("msync() failed");
-                if (posix_madvise(o->mmap_ptr + offset, length,
-                                  POSIX_MADV_DONTNEED) != 0)
+                if (posix_madvise(ptr, length, POSIX_MADV_DONTNEED) != 0)
                         ERR("madvise() failed");
         }
-        return (length);
 }
 
 /*
- * Perform msync().
+ * Write or read access to file using mmap, sliding the window to the accessed data
+ */
+static IOR_offset_t MMAP_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer,
+                               IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param)
+{
+        mmap_options_t *o = (mmap_options_t*) param;
+        mmap_fd_t * mfd = (mmap_fd_t*) file;
+
+        pthread_rwlock_rdlock(& mfd->lock);
+        if (mfd->map != NULL && offset >= mfd->map_offset && offset + length <= mfd->map_offset + mfd->map_length) {
+                MMAP_Copy(access, mfd, buffer, length, offset);
+                pthread_rwlock_unlock(& mfd->lock);
+                return length;
+        }
+        pthread_rwlock_unlock(& mfd->lock);
+
+        pthread_rwlock_wrlock(& mfd->lock);
+        if (mfd->map == NULL || offset < mfd->map_offset || offset + length > mfd->map_offset + mfd->map_length) {
+                if (MMAP_Window(mfd, offset, length, o) != 0) {
+                        pthread_rwlock_unlock(& mfd->lock);
+                        WARNF("access of %lld bytes at offset %lld beyond the end of the file", length, offset);
+                        return 0;
+                }
+        }
+        MMAP_Copy(access, mfd, buffer, length, offset);
+        pthread_rwlock_unlock(& mfd->lock);
+        return length;
+}
+
+/*
+ * Perform msync() of the mapped window and fsync() for the windows mapped before.
  */
 static void MMAP_Fsync(aiori_fd_t *fd, aiori_mod_opt_t * param)
 {
         mmap_options_t *o = (mmap_options_t*) param;
-        if (msync(o->mmap_ptr, hints->expectedAggFileSize, MS_SYNC) != 0)
+        mmap_fd_t * mfd = (mmap_fd_t*) fd;
+        pthread_rwlock_rdlock(& mfd->lock);
+        if (mfd->map != NULL && msync(mfd->map, mfd->map_length, MS_SYNC) != 0)
                 WARN("msync() failed");
+        pthread_rwlock_unlock(& mfd->lock);
+        POSIX_Fsync(mfd->pfd, o->p);
 }
 
 /*
@@ -192,8 +320,10 @@ static void MMAP_Fsync(aiori_fd_t *fd, aiori_mod_opt_t * param)
 static void MMAP_Close(aiori_fd_t *fd, aiori_mod_opt_t * param)
 {
         mmap_options_t *o = (mmap_options_t*) param;
-        if (munmap(o->mmap_ptr, hints->expectedAggFileSize) != 0)
+        mmap_fd_t * mfd = (mmap_fd_t*) fd;
+        if (mfd->map != NULL && munmap(mfd->map, mfd->map_length) != 0)
                 ERR("munmap failed");
-        o->mmap_ptr = NULL;
-        POSIX_Close(fd, param);
+        pthread_rwlock_destroy(& mfd->lock);
+        POSIX_Close(mfd->pfd, o->p);
+        free(mfd);
 }
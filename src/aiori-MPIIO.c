@@ -37,6 +37,7 @@ static aiori_fd_t *MPIIO_Create(char *, int iorflags, aiori_mod_opt_t *);
 static aiori_fd_t *MPIIO_Open(char *, int flags, aiori_mod_opt_t *);
 static IOR_offset_t MPIIO_Xfer(int, aiori_fd_t *, IOR_size_t *,
                                    IOR_offset_t, IOR_offset_t, aiori_mod_opt_t *);
+static IOR_offset_t MPIIO_Xferv(int, aiori_fd_t *, aiori_xfer_extent_t *, int, aiori_mod_opt_t *);
 static void MPIIO_Close(aiori_fd_t *, aiori_mod_opt_t *);
 static char* MPIIO_GetVersion();
 static void MPIIO_Fsync(aiori_fd_t *, aiori_mod_opt_t *);
@@ -83,6 +84,7 @@ ior_aiori_t mpiio_aiori = {
         .xfer_hints = MPIIO_xfer_hints,
         .open = MPIIO_Open,
         .xfer = MPIIO_Xfer,
+        .xferv = MPIIO_Xferv,
         .close = MPIIO_Close,
         .remove = MPIIO_Delete,
         .get_version = MPIIO_GetVersion,
@@ -103,6 +105,18 @@ void MPIIO_xfer_hints(aiori_xfer_hint_t * params){
   hints = params;
 }
 
+/*
+ * Returns the communicator of the processes that open the same file.
+ */
+static MPI_Comm FileComm(void)
+{
+        if (hints->filePerProc)
+                return MPI_COMM_SELF;
+        if (hints->ranksPerFile > 1)
+                return hints->fileComm;
+        return testComm;
+}
+
 static int MPIIO_check_params(aiori_mod_opt_t * module_options){
   mpiio_options_t * param = (mpiio_options_t*) module_options;
   if ((param->useFileView == TRUE)
@@ -120,6 +134,12 @@ static int MPIIO_check_params(aiori_mod_opt_t * module_options){
           ERR("random offset not available with collective MPIIO");
   if (hints->randomOffset && param->useFileView)
           ERR("random offset not available with MPIIO fileviews");
+  if (hints->variableTransferSize && param->useFileView)
+          ERR("variable transfer sizes not available with MPIIO fileviews");
+  if (hints->extentSize > 0 && param->useFileView)
+          ERR("extentSize not available with MPIIO fileviews");
+  if (hints->ranksPerFile > 1 && param->useFileView)
+          ERR("ranksPerFile not available with MPIIO fileviews");
 
   return 0;
 }
@@ -212,11 +232,7 @@ static aiori_fd_t *MPIIO_Open(char *testFileName, int flags, aiori_mod_opt_t * m
          */
         fd_mode |= MPI_MODE_UNIQUE_OPEN;
 
-        if (hints->filePerProc) {
-                comm = MPI_COMM_SELF;
-        } else {
-                comm = testComm;
-        }
+        comm = FileComm();
 
         SetHints(&mpiHints, param->hintsFileName);
         /*
@@ -256,7 +272,7 @@ static aiori_fd_t *MPIIO_Open(char *testFileName, int flags, aiori_mod_opt_t * m
                                                (MPI_Offset) (hints->segmentCount
                                                              *
                                                              hints->blockSize *
-                                                             hints->numTasks)),
+                                                             (hints->ranksPerFile > 1 ? hints->ranksPerFile : hints->numTasks))),
                           "cannot preallocate file");
         }
 
@@ -536,7 +552,96 @@ static IOR_offset_t MPIIO_Xfer(int access, aiori_fd_t * fdp, IOR_size_t * buffer
                         }
                 }
         }
-        return hints->transferSize;
+        return length;
+}
+
+/*
+ * Access count elements of type at offset of the current file view.
+ */
+static void MPIIO_AccessAt(int access, MPI_File fd, MPI_Offset offset, void * buffer, MPI_Count count, MPI_Datatype type)
+{
+        MPI_Status status;
+
+        if (access == WRITE) {
+                if (hints->collective) {
+                        MPI_CHECK(MPI_File_write_at_all_c(fd, offset, buffer, count, type, & status),
+                                  "cannot access explicit, collective");
+                } else {
+                        MPI_CHECK(MPI_File_write_at_c(fd, offset, buffer, count, type, & status),
+                                  "cannot access explicit, noncollective");
+                }
+        } else {
+                if (hints->collective) {
+                        MPI_CHECK(MPI_File_read_at_all_c(fd, offset, buffer, count, type, & status),
+                                  "cannot access explicit, collective");
+                } else {
+                        MPI_CHECK(MPI_File_read_at_c(fd, offset, buffer, count, type, & status),
+                                  "cannot access explicit, noncollective");
+                }
+        }
+}
+
+/*
+ * Vectored access with a single MPI call, the buffers are described by an
+ * hindexed datatype of absolute addresses.  If the extents are not
+ * contiguous in the file, an hindexed file view selects them; as
+ * MPI_File_set_view() is collective this requires collective I/O or a file
+ * per process, otherwise every extent is accessed separately.
+ */
+static IOR_offset_t MPIIO_Xferv(int access, aiori_fd_t * fdp, aiori_xfer_extent_t * extents,
+                                int count, aiori_mod_opt_t * module_options)
+{
+        mpiio_fd_t * mfd = (mpiio_fd_t*) fdp;
+        IOR_offset_t total = 0;
+        int contiguous = 1;
+
+        for (int i = 0; i < count; i++) {
+                if (extents[i].length > INT_MAX)
+                        ERR("extent too large for an MPI datatype");
+                if (i > 0 && extents[i].offset != extents[i - 1].offset + extents[i - 1].length)
+                        contiguous = 0;
+                total += extents[i].length;
+        }
+        if(hints->dryRun)
+          return total;
+
+        if (! contiguous && ! hints->collective && ! hints->filePerProc) {
+                for (int i = 0; i < count; i++)
+                        MPIIO_AccessAt(access, mfd->fd, extents[i].offset, extents[i].buffer, extents[i].length, MPI_BYTE);
+                return total;
+        }
+
+        int * lengths = safeMalloc(sizeof(int) * count);
+        MPI_Aint * displacements = safeMalloc(sizeof(MPI_Aint) * count);
+        MPI_Datatype memType;
+        for (int i = 0; i < count; i++) {
+                lengths[i] = (int) extents[i].length;
+                MPI_CHECK(MPI_Get_address(extents[i].buffer, & displacements[i]), "cannot get address");
+        }
+        MPI_CHECK(MPI_Type_create_hindexed(count, lengths, displacements, MPI_BYTE, & memType),
+                  "cannot create hindexed memory datatype");
+        MPI_CHECK(MPI_Type_commit(& memType), "cannot commit datatype");
+
+        if (contiguous) {
+                MPIIO_AccessAt(access, mfd->fd, extents[0].offset, MPI_BOTTOM, 1, memType);
+        } else {
+                MPI_Datatype fileType;
+                for (int i = 0; i < count; i++)
+                        displacements[i] = extents[i].offset - extents[0].offset;
+                MPI_CHECK(MPI_Type_create_hindexed(count, lengths, displacements, MPI_BYTE, & fileType),
+                          "cannot create hindexed file datatype");
+                MPI_CHECK(MPI_Type_commit(& fileType), "cannot commit datatype");
+                MPI_CHECK(MPI_File_set_view(mfd->fd, extents[0].offset, MPI_BYTE, fileType, "native", MPI_INFO_NULL),
+                          "cannot set file view");
+                MPIIO_AccessAt(access, mfd->fd, 0, MPI_BOTTOM, 1, memType);
+                MPI_CHECK(MPI_File_set_view(mfd->fd, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL),
+                          "cannot reset file view");
+                MPI_CHECK(MPI_Type_free(& fileType), "cannot free datatype");
+        }
+        MPI_CHECK(MPI_Type_free(& memType), "cannot free datatype");
+        free(lengths);
+        free(displacements);
+        return total;
 }
 
 /*
@@ -651,8 +756,11 @@ IOR_offset_t MPIIO_GetFileSize(aiori_mod_opt_t * module_options, char *testFileN
         IOR_offset_t aggFileSizeFromStat, tmpMin, tmpMax, tmpSum;
         MPI_File fd;
         MPI_Info mpiHints = MPI_INFO_NULL;
+        MPI_Comm comm = FileComm();
+        int fileRank;
 
-        if (hints->filePerProc || rank == 0) {
+        MPI_CHECK(MPI_Comm_rank(comm, & fileRank), "cannot get rank");
+        if (hints->filePerProc || fileRank == 0) {
                 if(test)
                         SetHints(&mpiHints, test->hintsFileName);
                 MPI_CHECK(MPI_File_open(MPI_COMM_SELF, testFileName, MPI_MODE_RDONLY,
@@ -665,7 +773,7 @@ IOR_offset_t MPIIO_GetFileSize(aiori_mod_opt_t * module_options, char *testFileN
                         MPI_CHECK(MPI_Info_free(&mpiHints), "MPI_Info_free failed");
         }
         if (!hints->filePerProc) {
-                MPI_CHECK(MPI_Bcast(&aggFileSizeFromStat, 1, MPI_INT64_T, 0, testComm),
+                MPI_CHECK(MPI_Bcast(&aggFileSizeFromStat, 1, MPI_INT64_T, 0, comm),
                           "cannot broadcast file_size");
         }
         return (aggFileSizeFromStat);
@@ -16,6 +16,10 @@
 #  include "config.h"
 #endif
 
+#ifdef __linux__
+#  define _DEFAULT_SOURCE         /* preadv() and pwritev() */
+#endif                          /* __linux__ */
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -23,6 +27,8 @@
 #  include <sys/ioctl.h>          /* necessary for: */
 #  define __USE_GNU               /* O_DIRECT and */
 #  include <fcntl.h>              /* IO operations */
+#  include <sys/uio.h>            /* preadv2(), pwritev2() and RWF_* */
+#  include <unistd.h>             /* syncfs() */
 #  undef __USE_GNU
 #endif                          /* __linux__ */
 
@@ -30,7 +36,11 @@
 #include <unistd.h>
 #include <fcntl.h>              /* IO operations */
 #include <sys/stat.h>
+#include <sys/mman.h>           /* mincore() */
+#include <sys/uio.h>            /* preadv(), pwritev() */
+#include <limits.h>             /* IOV_MAX */
 #include <assert.h>
+#include <pthread.h>
 
 #ifdef HAVE_GPFS_H
 #  include <gpfs.h>
@@ -63,17 +73,29 @@ typedef struct {
 #ifdef HAVE_GPU_DIRECT
   CUfileHandle_t cf_handle;
 #endif
+  long long nowait_reads;         /* reads issued with RWF_NOWAIT */
+  long long nowait_misses;        /* ... of which missed the page cache */
+  long long readahead_end;        /* end of the range prefetched with posix.readahead */
+  pthread_mutex_t seek_mutex;     /* the file offset is shared by the threads using the fd */
 } posix_fd;
 
+/* reads of the closed files, reported once per test by POSIX_Finalize() */
+static long long nowait_reads = 0;
+static long long nowait_misses = 0;
+
+/* RWF_UNCACHED was merged into Linux as RWF_DONTCACHE */
+#if ! defined(RWF_UNCACHED) && defined(RWF_DONTCACHE)
+#  define RWF_UNCACHED RWF_DONTCACHE
+#endif
+#if ! defined(RWF_UNCACHED) && defined(__linux__)
+#  define RWF_UNCACHED 0x00000080
+#endif
+
 
 #ifndef   open64                /* necessary for TRU64 -- */
 #  define open64  open            /* unlikely, but may pose */
 #endif  /* not open64 */                        /* conflicting prototypes */
 
-#ifndef   lseek64               /* necessary for TRU64 -- */
-#  define lseek64 lseek           /* unlikely, but may pose */
-#endif  /* not lseek64 */                        /* conflicting prototypes */
-
 #ifndef   O_BINARY              /* Required on Windows    */
 #  define O_BINARY 0
 #endif
@@ -104,6 +126,7 @@ static void POSIX_Finalize(aiori_mod_opt_t * options);
 
 static IOR_offset_t POSIX_Xfer(int, aiori_fd_t *, IOR_size_t *,
                                IOR_offset_t, IOR_offset_t, aiori_mod_opt_t *);
+static IOR_offset_t POSIX_Xferv(int, aiori_fd_t *, aiori_xfer_extent_t *, int, aiori_mod_opt_t *);
 
 option_help * POSIX_options(aiori_mod_opt_t ** init_backend_options, aiori_mod_opt_t * init_values){
   posix_options_t * o = malloc(sizeof(posix_options_t));
@@ -128,6 +151,16 @@ option_help * POSIX_options(aiori_mod_opt_t ** init_backend_options, aiori_mod_o
   option_help h [] = {
     {0, "posix.odirect", "Direct I/O Mode", OPTION_FLAG, 'd', & o->direct_io},
     {0, "posix.rangelocks", "Use range locks (read locks for read ops)", OPTION_FLAG, 'd', & o->range_locks},
+    {0, "posix.engine", "Syscall engine for transfers: seek, pread or preadv2", OPTION_OPTIONAL_ARGUMENT, 's', & o->engine},
+    {0, "posix.hipri", "preadv2 engine: polled completion (RWF_HIPRI), requires O_DIRECT", OPTION_FLAG, 'd', & o->rwf_hipri},
+    {0, "posix.nowait", "preadv2 engine: try reads from the page cache first (RWF_NOWAIT) and report the miss rate", OPTION_FLAG, 'd', & o->rwf_nowait},
+    {0, "posix.dsync", "preadv2 engine: synchronous data integrity for each write (RWF_DSYNC)", OPTION_FLAG, 'd', & o->rwf_dsync},
+    {0, "posix.uncached", "preadv2 engine: drop the page cache after each transfer (RWF_UNCACHED)", OPTION_FLAG, 'd', & o->rwf_uncached},
+    {0, "posix.fadvise", "Access pattern advice for each opened file: auto, sequential, random or willneed", OPTION_OPTIONAL_ARGUMENT, 's', & o->fadvise},
+    {0, "posix.readahead", "Prefetch the next N transfers ahead of each read", OPTION_OPTIONAL_ARGUMENT, 'd', & o->readahead},
+    {0, "posix.rwhint", "Write lifetime hint for each opened file (F_SET_RW_HINT): none, short, medium, long or extreme", OPTION_OPTIONAL_ARGUMENT, 's', & o->rw_hint},
+    {0, "posix.prealloc", "Before writing, outside of the timed region: fallocate, fallocate-keep-size or punch the file", OPTION_OPTIONAL_ARGUMENT, 's', & o->prealloc},
+    {0, "posix.sparse", "Before reading, outside of the timed region: replace the data of the file by holes", OPTION_FLAG, 'd', & o->sparse},
 #ifdef HAVE_BEEGFS_BEEGFS_H
     {0, "posix.beegfs.NumTargets", "", OPTION_OPTIONAL_ARGUMENT, 'd', & o->beegfs_numTargets},
     {0, "posix.beegfs.ChunkSize", "", OPTION_OPTIONAL_ARGUMENT, 'd', & o->beegfs_chunkSize},
@@ -176,6 +209,7 @@ ior_aiori_t posix_aiori = {
         .mknod = POSIX_Mknod,
         .open = POSIX_Open,
         .xfer = POSIX_Xfer,
+        .xferv = POSIX_Xferv,
         .close = POSIX_Close,
         .remove = POSIX_Delete,
         .xfer_hints = POSIX_xfer_hints,
@@ -191,7 +225,11 @@ ior_aiori_t posix_aiori = {
         .get_options = POSIX_options,
         .enable_mdtest = true,
         .sync = POSIX_Sync,
-        .check_params = POSIX_check_params
+        .prepare = POSIX_Prepare,
+        .cache_control = POSIX_CacheControl,
+        .cache_residency = POSIX_CacheResidency,
+        .check_params = POSIX_check_params,
+        .thread_safe = true
 };
 
 /***************************** F U N C T I O N S ******************************/
@@ -233,6 +271,102 @@ int POSIX_check_params(aiori_mod_opt_t * param){
     ERR("GPUDirect support is not compiled");
   }
 #endif
+  if(o->engine == NULL || strcasecmp(o->engine, "pread") == 0){
+    o->engine_type = POSIX_ENGINE_PREAD;
+  }else if(strcasecmp(o->engine, "seek") == 0){
+    o->engine_type = POSIX_ENGINE_SEEK;
+  }else if(strcasecmp(o->engine, "preadv2") == 0){
+    o->engine_type = POSIX_ENGINE_PREADV2;
+  }else{
+    ERRF("Unknown posix.engine \"%s\", use seek, pread or preadv2", o->engine);
+  }
+  o->rwf_flags = 0;
+  if(o->rwf_hipri || o->rwf_nowait || o->rwf_dsync || o->rwf_uncached){
+    if(o->engine_type != POSIX_ENGINE_PREADV2){
+      ERR("posix.hipri, posix.nowait, posix.dsync and posix.uncached require posix.engine=preadv2");
+    }
+  }
+  if(o->fadvise == NULL || strcasecmp(o->fadvise, "none") == 0){
+    o->fadvise_type = POSIX_FADVISE_NONE;
+  }else if(strcasecmp(o->fadvise, "auto") == 0){
+    o->fadvise_type = POSIX_FADVISE_AUTO;
+  }else if(strcasecmp(o->fadvise, "sequential") == 0){
+    o->fadvise_type = POSIX_FADVISE_SEQUENTIAL;
+  }else if(strcasecmp(o->fadvise, "random") == 0){
+    o->fadvise_type = POSIX_FADVISE_RANDOM;
+  }else if(strcasecmp(o->fadvise, "willneed") == 0){
+    o->fadvise_type = POSIX_FADVISE_WILLNEED;
+  }else{
+    ERRF("Unknown posix.fadvise \"%s\", use auto, sequential, random or willneed", o->fadvise);
+  }
+#ifndef HAVE_POSIX_FADVISE
+  if(o->fadvise_type != POSIX_FADVISE_NONE){
+    ERR("posix.fadvise requires posix_fadvise() which is not available");
+  }
+#endif
+  if(o->readahead < 0){
+    ERR("posix.readahead must be >= 0");
+  }
+  if(o->prealloc == NULL || strcasecmp(o->prealloc, "none") == 0){
+    o->prealloc_type = POSIX_PREALLOC_NONE;
+  }else if(strcasecmp(o->prealloc, "fallocate") == 0){
+    o->prealloc_type = POSIX_PREALLOC_FALLOCATE;
+  }else if(strcasecmp(o->prealloc, "fallocate-keep-size") == 0){
+    o->prealloc_type = POSIX_PREALLOC_KEEP_SIZE;
+  }else if(strcasecmp(o->prealloc, "punch") == 0){
+    o->prealloc_type = POSIX_PREALLOC_PUNCH;
+  }else{
+    ERRF("Unknown posix.prealloc \"%s\", use none, fallocate, fallocate-keep-size or punch", o->prealloc);
+  }
+#ifndef HAVE_FALLOCATE
+  if(o->prealloc_type == POSIX_PREALLOC_KEEP_SIZE || o->prealloc_type == POSIX_PREALLOC_PUNCH || o->sparse){
+    ERR("posix.prealloc=fallocate-keep-size, posix.prealloc=punch and posix.sparse require fallocate() which is not available");
+  }
+#endif
+  if(o->prealloc_type != POSIX_PREALLOC_NONE && o->lustre_set_striping){
+    ERR("posix.prealloc cannot be combined with the Lustre striping options as the file exists before it is created");
+  }
+  o->rw_hint_value = 0;
+  if(o->rw_hint != NULL){
+#ifdef F_SET_RW_HINT
+    const char * names[] = {"none", "short", "medium", "long", "extreme"};
+    const int values[] = {RWH_WRITE_LIFE_NONE, RWH_WRITE_LIFE_SHORT, RWH_WRITE_LIFE_MEDIUM, RWH_WRITE_LIFE_LONG, RWH_WRITE_LIFE_EXTREME};
+    for(int i = 0; i < 5; i++){
+      if(strcasecmp(o->rw_hint, names[i]) == 0){
+        o->rw_hint_value = values[i];
+      }
+    }
+    if(o->rw_hint_value == 0){
+      ERRF("Unknown posix.rwhint \"%s\", use none, short, medium, long or extreme", o->rw_hint);
+    }
+#else
+    ERR("posix.rwhint requires F_SET_RW_HINT which is not available");
+#endif
+  }
+  if(o->engine_type == POSIX_ENGINE_PREADV2){
+#if ! defined(HAVE_PREADV2) || ! defined(HAVE_PWRITEV2)
+    ERR("posix.engine=preadv2 is not supported by this system");
+#else
+    if(o->gpuDirect){
+      ERR("posix.engine=preadv2 cannot be used with GPUDirect");
+    }
+    if(o->rwf_hipri){
+      if(! o->direct_io){
+        ERR("posix.hipri requires posix.odirect");
+      }
+      o->rwf_flags |= RWF_HIPRI;
+    }
+    if(o->rwf_nowait){
+      o->rwf_flags |= RWF_NOWAIT;
+    }
+    if(o->rwf_dsync){
+      o->rwf_flags |= RWF_DSYNC;
+    }
+    if(o->rwf_uncached){
+      o->rwf_flags |= RWF_UNCACHED;
+    }
+#endif
+  }
   return 0;
 }
 
@@ -498,6 +632,67 @@ void lustre_disable_file_locks(const int fd) {
 }
 #endif /* HAVE_LUSTRE_USER */
 
+/*
+ * Apply the access pattern advice and the write lifetime hint to a new file descriptor.
+ */
+static void POSIX_ApplyHints(posix_fd * pfd, posix_options_t * o)
+{
+        pfd->readahead_end = 0;
+#ifdef HAVE_POSIX_FADVISE
+        int advice = -1;
+        switch(o->fadvise_type){
+        case POSIX_FADVISE_AUTO:
+                advice = hints->randomOffset ? POSIX_FADV_RANDOM : POSIX_FADV_SEQUENTIAL;
+                break;
+        case POSIX_FADVISE_SEQUENTIAL:
+                advice = POSIX_FADV_SEQUENTIAL;
+                break;
+        case POSIX_FADVISE_RANDOM:
+                advice = POSIX_FADV_RANDOM;
+                break;
+        case POSIX_FADVISE_WILLNEED:
+                advice = POSIX_FADV_WILLNEED;
+                break;
+        }
+        if (advice != -1) {
+                int ret = posix_fadvise(pfd->fd, 0, 0, advice);
+                if (ret != 0)
+                        WARNF("posix_fadvise(%d, %d) failed: %s", pfd->fd, advice, strerror(ret));
+        }
+#endif
+#ifdef F_SET_RW_HINT
+        if (o->rw_hint_value != 0) {
+                uint64_t hint = o->rw_hint_value;
+                if (fcntl(pfd->fd, F_SET_RW_HINT, & hint) != 0)
+                        WARNF("fcntl(%d, F_SET_RW_HINT, %s) failed: %s", pfd->fd, o->rw_hint, strerror(errno));
+        }
+#endif
+}
+
+/*
+ * Prefetch the posix.readahead transfers behind a read of [offset, offset + length)
+ * that were not yet requested, restarting the window if the reads moved elsewhere.
+ */
+static void POSIX_Readahead(posix_fd * pfd, posix_options_t * o, IOR_offset_t offset, IOR_offset_t length)
+{
+        long long end = offset + length;
+        long long target = end + length * o->readahead;
+        long long start = __atomic_load_n(& pfd->readahead_end, __ATOMIC_RELAXED);
+        if (start < end || start > target)
+                start = end;
+        if (start >= target)
+                return;
+#ifdef HAVE_READAHEAD
+        if (readahead(pfd->fd, start, target - start) != 0)
+                WARNF("readahead(%d, %lld, %lld) failed: %s", pfd->fd, start, target - start, strerror(errno));
+#elif defined(HAVE_POSIX_FADVISE)
+        int ret = posix_fadvise(pfd->fd, start, target - start, POSIX_FADV_WILLNEED);
+        if (ret != 0)
+                WARNF("posix_fadvise(%d, WILLNEED) failed: %s", pfd->fd, strerror(ret));
+#endif
+        __atomic_store_n(& pfd->readahead_end, target, __ATOMIC_RELAXED);
+}
+
 /*
  * Create and open a file through the POSIX interface.
  */
@@ -508,6 +703,9 @@ aiori_fd_t *POSIX_Create(char *testFileName, int flags, aiori_mod_opt_t * param)
         int mode = 0664;
         posix_fd * pfd = safeMalloc(sizeof(posix_fd));
         posix_options_t * o = (posix_options_t*) param;
+        pfd->nowait_reads = 0;
+        pfd->nowait_misses = 0;
+        pthread_mutex_init(& pfd->seek_mutex, NULL);
         if (o->direct_io == TRUE){
           set_o_direct_flag(& fd_oflag);
         }
@@ -522,10 +720,15 @@ aiori_fd_t *POSIX_Create(char *testFileName, int flags, aiori_mod_opt_t * param)
 #define FASYNC          00020000   /* fcntl, for BSD compatibility */
 #endif
         if (o->lustre_set_striping || o->lustre_set_pool) {
+                /* the first process of the ranks sharing the file sets the striping */
+                MPI_Comm comm = hints->ranksPerFile > 1 ? hints->fileComm : testComm;
+                int fileRank = 0;
+                if (!hints->filePerProc)
+                        MPI_CHECK(MPI_Comm_rank(comm, & fileRank), "cannot get rank");
 #ifdef HAVE_LUSTRE_LUSTREAPI
 
-                if (!hints->filePerProc && rank != 0) {
-                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+                if (!hints->filePerProc && fileRank != 0) {
+                        MPI_CHECK(MPI_Barrier(comm), "barrier error");
                         fd_oflag |= O_RDWR;
                         pfd->fd = open64(testFileName, fd_oflag, mode);
                         if (pfd->fd < 0){
@@ -550,14 +753,14 @@ aiori_fd_t *POSIX_Create(char *testFileName, int flags, aiori_mod_opt_t * param)
                                      testFileName, strerror(errno));
 
                         if (!hints->filePerProc)
-                                MPI_CHECK(MPI_Barrier(testComm),
+                                MPI_CHECK(MPI_Barrier(comm),
                                           "barrier error");                        
 
                 }
 
 #else
-                if (!hints->filePerProc && rank != 0) {
-                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+                if (!hints->filePerProc && fileRank != 0) {
+                        MPI_CHECK(MPI_Barrier(comm), "barrier error");
                         fd_oflag |= O_RDWR;
                         pfd->fd = open64(testFileName, fd_oflag, mode);
                         if (pfd->fd < 0){
@@ -587,7 +790,7 @@ aiori_fd_t *POSIX_Create(char *testFileName, int flags, aiori_mod_opt_t * param)
                         }
 
                         if (!hints->filePerProc)
-                                MPI_CHECK(MPI_Barrier(testComm),
+                                MPI_CHECK(MPI_Barrier(comm),
                                           "barrier error");                        
 
                 }
@@ -641,6 +844,7 @@ aiori_fd_t *POSIX_Create(char *testFileName, int flags, aiori_mod_opt_t * param)
         }
 #endif
 #endif
+        POSIX_ApplyHints(pfd, o);
 #ifdef HAVE_GPU_DIRECT
   if(o->gpuDirect){
     init_cufile(pfd);
@@ -678,6 +882,9 @@ aiori_fd_t *POSIX_Open(char *testFileName, int flags, aiori_mod_opt_t * param)
         }
         posix_fd * pfd = safeMalloc(sizeof(posix_fd));
         posix_options_t * o = (posix_options_t*) param;
+        pfd->nowait_reads = 0;
+        pfd->nowait_misses = 0;
+        pthread_mutex_init(& pfd->seek_mutex, NULL);
         if (o->direct_io == TRUE){
                 set_o_direct_flag(&fd_oflag);
         }
@@ -706,6 +913,7 @@ aiori_fd_t *POSIX_Open(char *testFileName, int flags, aiori_mod_opt_t * param)
         }
 #endif
 #endif
+        POSIX_ApplyHints(pfd, o);
 #ifdef HAVE_GPU_DIRECT
         if(o->gpuDirect){
           init_cufile(pfd);
@@ -717,6 +925,60 @@ aiori_fd_t *POSIX_Open(char *testFileName, int flags, aiori_mod_opt_t * param)
 /*
  * Write or read access to file using the POSIX interface.
  */
+/*
+ * Issue a single read or write with the syscall engine selected by posix.engine.
+ */
+static long long POSIX_EngineXfer(int access, posix_fd * pfd, char * ptr, long long length,
+                                  off_t offset, posix_options_t * o)
+{
+        long long rc;
+        switch(o->engine_type){
+        case POSIX_ENGINE_SEEK:
+                pthread_mutex_lock(& pfd->seek_mutex);
+                if (lseek(pfd->fd, offset, SEEK_SET) != offset){
+                        rc = -1;
+                }else if (access == WRITE){
+                        rc = write(pfd->fd, ptr, length);
+                }else{
+                        rc = read(pfd->fd, ptr, length);
+                }
+                pthread_mutex_unlock(& pfd->seek_mutex);
+                return rc;
+#if defined(HAVE_PREADV2) && defined(HAVE_PWRITEV2)
+        case POSIX_ENGINE_PREADV2:{
+                struct iovec iov = {.iov_base = ptr, .iov_len = length};
+                if (access == WRITE){
+                        return pwritev2(pfd->fd, & iov, 1, offset, o->rwf_flags & ~RWF_NOWAIT);
+                }
+                rc = preadv2(pfd->fd, & iov, 1, offset, o->rwf_flags);
+                if (! (o->rwf_flags & RWF_NOWAIT)){
+                        return rc;
+                }
+                __atomic_add_fetch(& pfd->nowait_reads, 1, __ATOMIC_RELAXED);
+                if (rc < 0 && errno == EAGAIN){
+                        rc = 0;
+                }else if (rc < 0 || rc == length){
+                        return rc;
+                }
+                /* (partially) missed the page cache, read the rest blocking */
+                __atomic_add_fetch(& pfd->nowait_misses, 1, __ATOMIC_RELAXED);
+                iov.iov_base = ptr + rc;
+                iov.iov_len = length - rc;
+                long long ret = preadv2(pfd->fd, & iov, 1, offset + rc, o->rwf_flags & ~RWF_NOWAIT);
+                if (ret < 0){
+                        return rc > 0 ? rc : ret;
+                }
+                return rc + ret;
+        }
+#endif
+        default:
+                if (access == WRITE){
+                        return pwrite(pfd->fd, ptr, length, offset);
+                }
+                return pread(pfd->fd, ptr, length, offset);
+        }
+}
+
 static IOR_offset_t POSIX_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer,
                                IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param)
 {
@@ -740,11 +1002,12 @@ static IOR_offset_t POSIX_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer
 #endif
 
 
-        /* seek to offset */
-        if (lseek64(fd, offset, SEEK_SET) == -1)
-                ERRF("lseek64(%d, %lld, SEEK_SET) failed", fd, offset);
+        /* positioned I/O, the file offset is not shared state between threads */
         off_t mem_offset = 0;
 
+        if (access != WRITE && o->readahead > 0)
+                POSIX_Readahead(pfd, o, offset, length);
+
         if(o->range_locks){
           struct flock lck = {
           .l_whence = SEEK_SET,
@@ -769,12 +1032,12 @@ static IOR_offset_t POSIX_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer
                           rc = cuFileWrite(pfd->cf_handle, ptr, remaining, offset + mem_offset, mem_offset);
                         }else{
 #endif
-                          rc = write(fd, ptr, remaining);
+                          rc = POSIX_EngineXfer(access, pfd, ptr, remaining, offset + mem_offset, o);
 #ifdef HAVE_GPU_DIRECT
                         }
 #endif
                         if (rc < 0){
-                          WARNF("write(%d, %p, %lld) failed %s", fd, (void*)ptr, remaining, strerror(errno));
+                          WARNF("pwrite(%d, %p, %lld) failed %s", fd, (void*)ptr, remaining, strerror(errno));
                         }
                         if (hints->fsyncPerWrite == TRUE){
                           POSIX_Fsync((aiori_fd_t*) &fd, param);
@@ -790,24 +1053,24 @@ static IOR_offset_t POSIX_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer
                           rc = cuFileRead(pfd->cf_handle, ptr, remaining, offset + mem_offset, mem_offset);
                         }else{
 #endif
-                          rc = read(fd, ptr, remaining);
+                          rc = POSIX_EngineXfer(access, pfd, ptr, remaining, offset + mem_offset, o);
 #ifdef HAVE_GPU_DIRECT
                         }
 #endif
                         if (rc == 0){
-                          WARNF("read(%d, %p, %lld) returned EOF prematurely", fd, (void*)ptr, remaining);
+                          WARNF("pread(%d, %p, %lld) returned EOF prematurely", fd, (void*)ptr, remaining);
                           return length - remaining;
                         }
                                 
                         if (rc < 0){
-                          WARNF("read(%d, %p, %lld) failed %s", fd, (void*)ptr, remaining, strerror(errno));
+                          WARNF("pread(%d, %p, %lld) failed %s", fd, (void*)ptr, remaining, strerror(errno));
                           return length - remaining;
                         }
                 }
                 if (rc < remaining) {
                         WARNF("task %d, partial %s, %lld of %lld bytes at offset %lld\n",
                                 rank,
-                                access == WRITE ? "write()" : "read()",
+                                access == WRITE ? "pwrite()" : "pread()",
                                 rc, remaining,
                                 offset + length - remaining);
                         if (xferRetries > MAX_RETRY || hints->singleXferAttempt){
@@ -841,6 +1104,120 @@ static IOR_offset_t POSIX_Xfer(int access, aiori_fd_t *file, IOR_size_t * buffer
         return (length);
 }
 
+/*
+ * Transfer the iovecs to or from the contiguous file region at offset,
+ * partial transfers are continued with the remaining iovecs.
+ * Returns the number of bytes transferred.
+ */
+static IOR_offset_t POSIX_Xfer_iov(int access, int fd, struct iovec * iov, int count, IOR_offset_t offset, int rwf_flags)
+{
+        IOR_offset_t done = 0;
+        int xferRetries = 0;
+
+        while (count > 0) {
+                ssize_t rc;
+                if (access == WRITE) {
+#if defined(HAVE_PREADV2) && defined(HAVE_PWRITEV2)
+                        if (rwf_flags)
+                          rc = pwritev2(fd, iov, count, offset + done, rwf_flags);
+                        else
+#endif
+                          rc = pwritev(fd, iov, count, offset + done);
+                        if (rc < 0){
+                          WARNF("pwritev(%d, %d iovecs) failed %s", fd, count, strerror(errno));
+                          return done;
+                        }
+                } else {
+#if defined(HAVE_PREADV2) && defined(HAVE_PWRITEV2)
+                        if (rwf_flags)
+                          rc = preadv2(fd, iov, count, offset + done, rwf_flags);
+                        else
+#endif
+                          rc = preadv(fd, iov, count, offset + done);
+                        if (rc == 0){
+                          WARNF("preadv(%d, %d iovecs) returned EOF prematurely", fd, count);
+                          return done;
+                        }
+                        if (rc < 0){
+                          WARNF("preadv(%d, %d iovecs) failed %s", fd, count, strerror(errno));
+                          return done;
+                        }
+                }
+                done += rc;
+                while (count > 0 && (size_t) rc >= iov->iov_len) {
+                        rc -= iov->iov_len;
+                        iov++;
+                        count--;
+                }
+                if (count > 0) {
+                        WARNF("task %d, partial %s at offset %lld\n", rank,
+                              access == WRITE ? "pwritev()" : "preadv()", offset + done);
+                        if (xferRetries++ > MAX_RETRY || hints->singleXferAttempt){
+                          WARN("too many retries -- aborting");
+                          return done;
+                        }
+                        iov->iov_base = (char *) iov->iov_base + rc;
+                        iov->iov_len -= rc;
+                }
+        }
+        return done;
+}
+
+/*
+ * Vectored access, every run of extents that is contiguous in the file is
+ * accessed with a single pwritev()/preadv(), the buffers may be scattered.
+ * Extents separated by holes in the file need one call per run.
+ */
+static IOR_offset_t POSIX_Xferv(int access, aiori_fd_t *file, aiori_xfer_extent_t * extents,
+                                int count, aiori_mod_opt_t * param)
+{
+        posix_options_t * o = (posix_options_t*) param;
+        posix_fd * pfd = (posix_fd *) file;
+        struct iovec iov[IOV_MAX < 1024 ? IOV_MAX : 1024];
+        const int max_iov = sizeof(iov) / sizeof(struct iovec);
+        IOR_offset_t total = 0;
+
+        if (hints->dryRun || o->range_locks || o->gpfs_hint_access || o->gpuDirect
+            || o->engine_type == POSIX_ENGINE_SEEK || o->rwf_nowait) {
+                /* the hints, locks, seeks and RWF_NOWAIT accounting are per extent */
+                for (int i = 0; i < count; i++) {
+                        IOR_offset_t ret = POSIX_Xfer(access, file, extents[i].buffer, extents[i].length, extents[i].offset, param);
+                        total += ret;
+                        if (ret != extents[i].length)
+                                break;
+                }
+                return total;
+        }
+
+        if (access != WRITE && o->readahead > 0 && count > 0)
+                POSIX_Readahead(pfd, o, extents[0].offset, extents[count - 1].offset + extents[count - 1].length - extents[0].offset);
+
+        for (int i = 0; i < count; ) {
+                IOR_offset_t offset = extents[i].offset;
+                IOR_offset_t length = 0;
+                int n = 0;
+                while (i < count && n < max_iov && extents[i].offset == offset + length) {
+                        iov[n].iov_base = extents[i].buffer;
+                        iov[n].iov_len = extents[i].length;
+                        length += extents[i].length;
+                        n++;
+                        i++;
+                }
+                if (verbose >= VERBOSE_4) {
+                        INFOF("task %d %s %d extents at offset %lld\n", rank,
+                              access == WRITE ? "writing" : "reading", n, offset);
+                }
+                IOR_offset_t ret = POSIX_Xfer_iov(access, pfd->fd, iov, n, offset, o->rwf_flags);
+                total += ret;
+                if (ret != length)
+                        return total;
+        }
+        if (access == WRITE && hints->fsyncPerWrite == TRUE){
+                POSIX_Fsync(file, param);
+        }
+        return total;
+}
+
 void POSIX_Fsync(aiori_fd_t *afd, aiori_mod_opt_t * param)
 {
     int fd = ((posix_fd*) afd)->fd;
@@ -851,10 +1228,175 @@ void POSIX_Fsync(aiori_fd_t *afd, aiori_mod_opt_t * param)
 
 void POSIX_Sync(aiori_mod_opt_t * param)
 {
-  int ret = system("sync");
-  if (ret != 0){
-    FAIL("Error executing the sync command, ensure it exists.");
-  }
+  sync();
+}
+
+/*
+ * The part of the file prepared by this process, the size of the file is split
+ * evenly in page aligned parts between the processes sharing it.
+ */
+static void POSIX_FileShare(IOR_offset_t * offset, IOR_offset_t * length, IOR_offset_t * size)
+{
+        MPI_Comm comm = testComm;
+        IOR_offset_t files = 1;
+        int index, count;
+
+        if (hints->filePerProc) {
+                comm = MPI_COMM_SELF;
+                files = hints->numTasks;
+        } else if (hints->ranksPerFile > 1) {
+                comm = hints->fileComm;
+                files = hints->numTasks / hints->ranksPerFile;
+        }
+        MPI_CHECK(MPI_Comm_rank(comm, & index), "cannot get rank");
+        MPI_CHECK(MPI_Comm_size(comm, & count), "cannot get size");
+        *size = hints->expectedAggFileSize / files;
+        IOR_offset_t share = ((*size + count - 1) / count + 4095) / 4096 * 4096;
+        *offset = share * index < *size ? share * index : *size;
+        *length = (*offset + share < *size ? *offset + share : *size) - *offset;
+}
+
+/*
+ * Preallocate or punch the blocks of the file before writing, or replace its
+ * data by holes before reading, each process handling its share of the file.
+ */
+int POSIX_Prepare(char *testFileName, int access, aiori_mod_opt_t * param)
+{
+        posix_options_t * o = (posix_options_t*) param;
+        IOR_offset_t offset, length, size;
+
+        if(hints->dryRun)
+          return 0;
+        if (access == WRITE && o->prealloc_type != POSIX_PREALLOC_NONE) {
+                posix_fd * pfd = (posix_fd *) POSIX_Create(testFileName, IOR_WRONLY | IOR_CREAT, param);
+                POSIX_FileShare(& offset, & length, & size);
+                int ret = 0;
+                if (length > 0) {
+                        switch(o->prealloc_type){
+                        case POSIX_PREALLOC_FALLOCATE:
+#ifdef HAVE_FALLOCATE
+                                ret = fallocate(pfd->fd, 0, offset, length) == 0 ? 0 : errno;
+#else
+                                ret = posix_fallocate(pfd->fd, offset, length);
+#endif
+                                break;
+#ifdef HAVE_FALLOCATE
+                        case POSIX_PREALLOC_KEEP_SIZE:
+                                ret = fallocate(pfd->fd, FALLOC_FL_KEEP_SIZE, offset, length) == 0 ? 0 : errno;
+                                break;
+                        case POSIX_PREALLOC_PUNCH:
+                                ret = fallocate(pfd->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) == 0 ? 0 : errno;
+                                break;
+#endif
+                        }
+                }
+                if (ret != 0)
+                        ERRF("posix.prealloc=%s of %lld bytes at offset %lld of \"%s\" failed: %s",
+                             o->prealloc, length, offset, testFileName, strerror(ret));
+                POSIX_Close((aiori_fd_t *) pfd, param);
+                return 1;
+        }
+#ifdef HAVE_FALLOCATE
+        if (o->sparse && (access == READ || access == READCHECK)) {
+                if (access == READCHECK)
+                        ERR("posix.sparse replaces the data by holes, it cannot be verified with -R");
+                int fd = open64(testFileName, O_WRONLY | O_CREAT, 0664);
+                if (fd < 0)
+                        ERRF("open64(\"%s\", O_WRONLY | O_CREAT) failed: %s", testFileName, strerror(errno));
+                POSIX_FileShare(& offset, & length, & size);
+                if (ftruncate(fd, size) != 0)
+                        ERRF("ftruncate(\"%s\", %lld) failed: %s", testFileName, size, strerror(errno));
+                if (length > 0 && fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, length) != 0)
+                        ERRF("punching %lld bytes at offset %lld of \"%s\" failed: %s",
+                             length, offset, testFileName, strerror(errno));
+                if (close(fd) != 0)
+                        ERRF("close(\"%s\") failed: %s", testFileName, strerror(errno));
+                return 1;
+        }
+#endif
+        return 0;
+}
+
+/*
+ * Write back and drop the cached data of a file without affecting other files,
+ * or write back only the file system holding it.
+ */
+void POSIX_CacheControl(char *testFileName, int operations, aiori_mod_opt_t * param)
+{
+        if(hints->dryRun)
+          return;
+        int fd = open64(testFileName, O_RDONLY);
+        if (fd < 0)
+                ERRF("open64(\"%s\", O_RDONLY) failed: %s", testFileName, strerror(errno));
+        if (operations & IOR_CACHE_SYNCFS){
+#ifdef HAVE_SYNCFS
+                if (syncfs(fd) != 0)
+                        WARNF("syncfs(\"%s\") failed: %s", testFileName, strerror(errno));
+#else
+                sync();
+#endif
+        }
+        if (operations & IOR_CACHE_DROP){
+                if (fdatasync(fd) != 0)
+                        WARNF("fdatasync(\"%s\") failed: %s", testFileName, strerror(errno));
+#ifdef HAVE_POSIX_FADVISE
+                int ret = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+                if (ret != 0)
+                        WARNF("posix_fadvise(\"%s\", DONTNEED) failed: %s", testFileName, strerror(ret));
+#else
+                WARN("posix_fadvise() is not available, the cached data is not dropped");
+#endif
+        }
+        if (close(fd) != 0)
+                ERRF("close(\"%s\") failed: %s", testFileName, strerror(errno));
+}
+
+/*
+ * Count the pages of a file held in the page cache with mincore(), mapping one
+ * window of the file at a time.
+ */
+IOR_offset_t POSIX_CacheResidency(char *testFileName, IOR_offset_t * resident, aiori_mod_opt_t * param)
+{
+#ifdef HAVE_MINCORE
+        const size_t window = 1024 * 1024 * 1024;
+        long pagesize = sysconf(_SC_PAGESIZE);
+        IOR_offset_t pages = 0;
+        struct stat st;
+
+        *resident = 0;
+        if(hints->dryRun)
+          return 0;
+        int fd = open64(testFileName, O_RDONLY);
+        if (fd < 0 || fstat(fd, & st) != 0){
+                WARNF("cannot open \"%s\" to sample the cache: %s", testFileName, strerror(errno));
+                if (fd >= 0)
+                        close(fd);
+                return -1;
+        }
+        unsigned char * vec = safeMalloc(window / pagesize);
+        for (off_t offset = 0; offset < st.st_size; offset += window) {
+                size_t length = st.st_size - offset < window ? st.st_size - offset : window;
+                size_t count = (length + pagesize - 1) / pagesize;
+                void * map = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, offset);
+                if (map == MAP_FAILED || mincore(map, length, (void *) vec) != 0){
+                        WARNF("cannot sample the cache of \"%s\": %s", testFileName, strerror(errno));
+                        if (map != MAP_FAILED)
+                                munmap(map, length);
+                        pages = -1;
+                        break;
+                }
+                for (size_t i = 0; i < count; i++)
+                        *resident += vec[i] & 1;
+                pages += count;
+                munmap(map, length);
+        }
+        free(vec);
+        close(fd);
+        return pages;
+#else
+        *resident = 0;
+        return -1;
+#endif
 }
 
 
@@ -866,7 +1408,11 @@ void POSIX_Close(aiori_fd_t *afd, aiori_mod_opt_t * param)
         if(hints->dryRun)
           return;
         posix_options_t * o = (posix_options_t*) param;
-        int fd = ((posix_fd*) afd)->fd;
+        posix_fd * pfd = (posix_fd*) afd;
+        int fd = pfd->fd;
+        nowait_reads += pfd->nowait_reads;
+        nowait_misses += pfd->nowait_misses;
+        pthread_mutex_destroy(& pfd->seek_mutex);
 #ifdef HAVE_GPU_DIRECT
         if(o->gpuDirect){
           cuFileHandleDeregister(((posix_fd*) afd)->cf_handle);
@@ -926,7 +1472,23 @@ void POSIX_Initialize(aiori_mod_opt_t * options){
 }
 
 void POSIX_Finalize(aiori_mod_opt_t * options){
+  posix_options_t * o = (posix_options_t*) options;
 #ifdef HAVE_GPU_DIRECT
   CUfileError_t err = cuFileDriverClose();
 #endif
+  if(o->rwf_nowait){
+    /* the miss rate of all tasks, next to the results of the test */
+    MPI_Comm com = testComm == MPI_COMM_NULL ? MPI_COMM_WORLD : testComm;
+    long long counts[2] = {nowait_reads, nowait_misses};
+    long long totals[2];
+    int com_rank;
+    MPI_CHECK(MPI_Comm_rank(com, & com_rank), "cannot get rank");
+    MPI_CHECK(MPI_Reduce(counts, totals, 2, MPI_LONG_LONG_INT, MPI_SUM, 0, com), "cannot reduce RWF_NOWAIT reads");
+    if(com_rank == 0 && totals[0] > 0){
+      fprintf(out_logfile, "RWF_NOWAIT missed the page cache for %lld of %lld reads (%.1f%%)\n",
+              totals[1], totals[0], 100.0 * totals[1] / totals[0]);
+    }
+    nowait_reads = 0;
+    nowait_misses = 0;
+  }
 }
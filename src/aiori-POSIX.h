@@ -18,7 +18,6 @@
 
 /************************** O P T I O N S *****************************/
 typedef struct{
-  /* in case of a change, please update depending MMAP module too */
   int direct_io;
 
   /* Lustre variables */
@@ -44,9 +43,54 @@ typedef struct{
   int beegfs_chunkSize;            /* srtipe pattern for new files */
   int gpuDirect;
   int range_locks;                 /* use POSIX range locks for writes */
+
+  /* syscall engine */
+  char * engine;                   /* seek, pread or preadv2 */
+  int engine_type;                 /* parsed engine, see posix_engine_t */
+  int rwf_hipri;                   /* preadv2: polled completion */
+  int rwf_nowait;                  /* preadv2: fail reads that miss the page cache */
+  int rwf_dsync;                   /* pwritev2: per-write O_DSYNC */
+  int rwf_uncached;                /* preadv2: drop the pages after the I/O */
+  int rwf_flags;                   /* combined RWF_* flags */
+
+  /* access pattern hints, applied per file descriptor */
+  char * fadvise;                  /* auto, sequential, random or willneed */
+  int fadvise_type;                /* parsed advice, see posix_fadvise_t */
+  int readahead;                   /* transfers prefetched ahead of each read */
+  char * rw_hint;                  /* write lifetime hint: none, short, medium, long or extreme */
+  int rw_hint_value;               /* parsed RWH_WRITE_LIFE_* value, 0 if not set */
+
+  /* file layout before the timed phases */
+  char * prealloc;                 /* fallocate, fallocate-keep-size or punch before writing */
+  int prealloc_type;               /* parsed mode, see posix_prealloc_t */
+  int sparse;                      /* replace the data by holes before reading */
 } posix_options_t;
 
+typedef enum {
+  POSIX_PREALLOC_NONE = 0,
+  POSIX_PREALLOC_FALLOCATE,        /* allocate the blocks and extend the file */
+  POSIX_PREALLOC_KEEP_SIZE,        /* allocate the blocks beyond the end of the file */
+  POSIX_PREALLOC_PUNCH             /* deallocate the blocks of an existing file */
+} posix_prealloc_t;
+
+typedef enum {
+  POSIX_FADVISE_NONE = 0,          /* no advice */
+  POSIX_FADVISE_AUTO,              /* random or sequential depending on randomOffset */
+  POSIX_FADVISE_SEQUENTIAL,
+  POSIX_FADVISE_RANDOM,
+  POSIX_FADVISE_WILLNEED
+} posix_fadvise_t;
+
+typedef enum {
+  POSIX_ENGINE_PREAD = 0,          /* pread()/pwrite() */
+  POSIX_ENGINE_SEEK,               /* lseek() followed by read()/write() */
+  POSIX_ENGINE_PREADV2             /* preadv2()/pwritev2() with RWF_* flags */
+} posix_engine_t;
+
 void POSIX_Sync(aiori_mod_opt_t * param);
+int POSIX_Prepare(char *testFileName, int access, aiori_mod_opt_t * param);
+void POSIX_CacheControl(char *testFileName, int operations, aiori_mod_opt_t * param);
+IOR_offset_t POSIX_CacheResidency(char *testFileName, IOR_offset_t * resident, aiori_mod_opt_t * param);
 int POSIX_check_params(aiori_mod_opt_t * param);
 void POSIX_Fsync(aiori_fd_t *, aiori_mod_opt_t *);
 int POSIX_check_params(aiori_mod_opt_t * options);
@@ -278,6 +278,10 @@ static int S3_check_params(aiori_mod_opt_t * test){
     ERR("N:1 (strided) requires xfer-size == block-size");
     return 1;
   }
+  if (hints->variableTransferSize) {
+    ERR("variable transfer sizes are not supported, the parts of a multi-part upload have the same size");
+    return 1;
+  }
 
   return 0;
 }
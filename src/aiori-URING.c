@@ -0,0 +1,527 @@
+/*
+ This backend uses io_uring
+ Requires: liburing-dev (>= 2.2)
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <liburing.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "ior.h"
+#include "aiori.h"
+#include "iordef.h"
+#include "utilities.h"
+
+#include "aiori-POSIX.h"
+
+#define URING_MAX_FILES 64
+
+/************************** O P T I O N S *****************************/
+/* one slot per op in flight, the ring of slots is preallocated */
+typedef struct uring_slot_t{
+  void * buffer; // aligned buffer owned by the slot, used by uring_Xfer()
+  void * tag; // tag of uring_Xfer_submit(), NULL for ops of uring_Xfer()
+  IOR_offset_t length;
+} uring_slot_t;
+
+typedef struct{
+  aiori_mod_opt_t * p; // posix options
+  int depth; // number of submission queue entries and max ops in flight
+  int batch; // submit every batch prepared ops
+  int sqpoll; // kernel thread polls the submission queue
+  int sqpoll_idle; // idle time in ms before the kernel thread sleeps
+  int iopoll; // busy-wait for completions, requires O_DIRECT
+  int no_fixed_buffers; // do not register buffers
+  int no_fixed_files; // do not register file descriptors
+
+  // runtime data
+  struct io_uring ring;
+  int prepared; // prepared but not yet submitted ops
+  int in_flight; // total pending ops
+  uring_slot_t * slots; // ring of depth slots
+  uring_slot_t ** free_slots; // stack of unused slots
+  int free_count;
+  IOR_offset_t slot_size; // size of the buffers of the slots, 0 if not allocated
+
+  int fixed_buffers; // 1 if the buffers of the slots are registered, 0 if not yet, -1 if registration is not available
+  struct iovec * buffers; // the registered buffers, entry i is the buffer of slot i
+  int fixed_files; // 1 if the table of registered files is available
+  int files[URING_MAX_FILES]; // registered file descriptors, -1 if free
+} uring_options_t;
+
+option_help * uring_options(aiori_mod_opt_t ** init_backend_options, aiori_mod_opt_t * init_values){
+  uring_options_t * o = malloc(sizeof(uring_options_t));
+
+  if (init_values != NULL){
+    memcpy(o, init_values, sizeof(uring_options_t));
+  }else{
+    memset(o, 0, sizeof(uring_options_t));
+    o->depth = 128;
+    o->batch = 16;
+    o->sqpoll_idle = 1000;
+  }
+  option_help * p_help = POSIX_options((aiori_mod_opt_t**)& o->p, init_values == NULL ? NULL : (aiori_mod_opt_t*) ((uring_options_t*)init_values)->p);
+  *init_backend_options = (aiori_mod_opt_t*) o;
+
+  option_help h [] = {
+    {0, "uring.depth", "Number of submission queue entries, max number of pending ops", OPTION_OPTIONAL_ARGUMENT, 'd', & o->depth},
+    {0, "uring.batch", "Submit pending IOs every *batch* elements", OPTION_OPTIONAL_ARGUMENT, 'd', & o->batch},
+    {0, "uring.sqpoll", "Use a kernel thread to poll the submission queue (IORING_SETUP_SQPOLL)", OPTION_FLAG, 'd', & o->sqpoll},
+    {0, "uring.sqpoll-idle", "Idle time in ms before the submission queue thread sleeps", OPTION_OPTIONAL_ARGUMENT, 'd', & o->sqpoll_idle},
+    {0, "uring.iopoll", "Busy-wait for completions (IORING_SETUP_IOPOLL), requires --posix.odirect", OPTION_FLAG, 'd', & o->iopoll},
+    {0, "uring.no-fixed-buffers", "Do not register the I/O buffers", OPTION_FLAG, 'd', & o->no_fixed_buffers},
+    {0, "uring.no-fixed-files", "Do not register the file descriptors", OPTION_FLAG, 'd', & o->no_fixed_files},
+    LAST_OPTION
+  };
+  option_help * help = option_merge(h, p_help);
+  free(p_help);
+  return help;
+}
+
+
+/************************** D E C L A R A T I O N S ***************************/
+
+typedef struct{
+  aiori_fd_t * pfd; // the underlying POSIX fd
+  int fd; // the file descriptor or the index of the registered file
+  int fixed; // 1 if fd is the index of a registered file
+} uring_fd_t;
+
+/***************************** F U N C T I O N S ******************************/
+
+static aiori_xfer_hint_t * hints = NULL;
+
+static void uring_xfer_hints(aiori_xfer_hint_t * params){
+  hints = params;
+  POSIX_xfer_hints(params);
+}
+
+static void uring_initialize(aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  struct io_uring_params params;
+  memset(& params, 0, sizeof(params));
+  if(o->sqpoll){
+    params.flags |= IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = o->sqpoll_idle;
+  }
+  if(o->iopoll){
+    params.flags |= IORING_SETUP_IOPOLL;
+  }
+  int ret = io_uring_queue_init_params(o->depth, & o->ring, & params);
+  if(ret != 0){
+    ERRF("Couldn't initialize io_uring %s", strerror(-ret));
+  }
+  o->prepared = 0;
+  o->in_flight = 0;
+
+  o->slots = malloc(sizeof(uring_slot_t) * o->depth);
+  o->free_slots = malloc(sizeof(uring_slot_t *) * o->depth);
+  o->buffers = malloc(sizeof(struct iovec) * o->depth);
+  if(o->slots == NULL || o->free_slots == NULL || o->buffers == NULL){
+    ERR("URING: cannot allocate the ring of pending ops");
+  }
+  for(int i = 0; i < o->depth; i++){
+    o->slots[i].buffer = NULL;
+    o->free_slots[i] = & o->slots[i];
+  }
+  o->free_count = o->depth;
+  o->slot_size = 0;
+
+  /* the buffers of the slots are registered once they are allocated */
+  o->fixed_buffers = -1;
+  if(! o->no_fixed_buffers){
+    ret = io_uring_register_buffers_sparse(& o->ring, o->depth);
+    if(ret == 0){
+      o->fixed_buffers = 0;
+    }else{
+      WARNF("URING: cannot register buffers, using unregistered buffers: %s", strerror(-ret));
+    }
+  }
+
+  o->fixed_files = 0;
+  for(int i = 0; i < URING_MAX_FILES; i++){
+    o->files[i] = -1;
+  }
+  if(! o->no_fixed_files){
+    ret = io_uring_register_files(& o->ring, o->files, URING_MAX_FILES);
+    if(ret == 0){
+      o->fixed_files = 1;
+    }else{
+      WARNF("URING: cannot register files, using unregistered files: %s", strerror(-ret));
+    }
+  }
+}
+
+/* clear the first count entries of the table of registered buffers */
+static void unregister_buffers(uring_options_t * o, int count){
+  for(int i = 0; i < count; i++){
+    o->buffers[i].iov_base = NULL;
+    o->buffers[i].iov_len = 0;
+  }
+  int ret = io_uring_register_buffers_update_tag(& o->ring, 0, o->buffers, NULL, count);
+  if(ret != count){
+    ERRF("URING: cannot unregister buffers: %s", ret < 0 ? strerror(-ret) : "partial update");
+  }
+}
+
+/* the buffers are unregistered before they are freed, the kernel must not access them anymore */
+static void free_slot_buffers(uring_options_t * o){
+  if(o->fixed_buffers == 1){
+    unregister_buffers(o, o->depth);
+    o->fixed_buffers = 0;
+  }
+  for(int i = 0; i < o->depth; i++){
+    if(o->slots[i].buffer){
+      aligned_buffer_free(o->slots[i].buffer, IOR_MEMORY_TYPE_CPU);
+      o->slots[i].buffer = NULL;
+    }
+  }
+  o->slot_size = 0;
+}
+
+static void complete_all(uring_options_t * o);
+
+/* allocate and register the buffers of the slots for the largest transfer, outside of the timed transfers */
+static void alloc_slot_buffers(uring_options_t * o){
+  if(o->slot_size >= hints->transferSize){
+    return;
+  }
+  complete_all(o);
+  free_slot_buffers(o);
+  for(int i = 0; i < o->depth; i++){
+    o->slots[i].buffer = aligned_buffer_alloc(hints->transferSize, IOR_MEMORY_TYPE_CPU);
+    o->buffers[i].iov_base = o->slots[i].buffer;
+    o->buffers[i].iov_len = hints->transferSize;
+  }
+  o->slot_size = hints->transferSize;
+  if(o->fixed_buffers != 0){
+    return;
+  }
+  int ret = io_uring_register_buffers_update_tag(& o->ring, 0, o->buffers, NULL, o->depth);
+  if(ret == o->depth){
+    o->fixed_buffers = 1;
+    return;
+  }
+  WARNF("URING: cannot register buffers, using unregistered buffers: %s", ret < 0 ? strerror(-ret) : "partial update");
+  if(ret > 0){
+    unregister_buffers(o, ret);
+  }
+  o->fixed_buffers = -1;
+}
+
+static void uring_finalize(aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  free_slot_buffers(o);
+  io_uring_queue_exit(& o->ring);
+  free(o->slots);
+  free(o->free_slots);
+  free(o->buffers);
+}
+
+static int uring_check_params(aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  POSIX_check_params((aiori_mod_opt_t*) o->p);
+  if(o->depth < 1){
+    ERRF("URING depth = %d < 1", o->depth);
+  }
+  if(o->batch < 1 || o->batch > o->depth){
+    ERRF("URING batch must be between 1 and depth, is %d", o->batch);
+  }
+  if(o->iopoll && ! ((posix_options_t*) o->p)->direct_io){
+    ERR("URING iopoll requires O_DIRECT, use --posix.odirect");
+  }
+  if(hints && hints->queueDepth > o->depth){
+    ERRF("URING depth must be >= queueDepth, is %d < %d", o->depth, hints->queueDepth);
+  }
+  return 0;
+}
+
+/* register the file if possible */
+static aiori_fd_t * uring_register_fd(uring_options_t * o, aiori_fd_t * pfd){
+  uring_fd_t * fd = malloc(sizeof(uring_fd_t));
+  fd->pfd = pfd;
+  fd->fd = *(int*)pfd;
+  fd->fixed = 0;
+  if(! o->fixed_files){
+    return (aiori_fd_t*) fd;
+  }
+  for(int i = 0; i < URING_MAX_FILES; i++){
+    if(o->files[i] != -1){
+      continue;
+    }
+    int ret = io_uring_register_files_update(& o->ring, i, & fd->fd, 1);
+    if(ret != 1){
+      WARNF("URING: cannot register file: %s", strerror(-ret));
+      break;
+    }
+    o->files[i] = fd->fd;
+    fd->fd = i;
+    fd->fixed = 1;
+    break;
+  }
+  return (aiori_fd_t*) fd;
+}
+
+static aiori_fd_t *uring_Open(char *testFileName, int flags, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  aiori_fd_t * fd = uring_register_fd(o, POSIX_Open(testFileName, flags, o->p));
+  alloc_slot_buffers(o);
+  return fd;
+}
+
+static aiori_fd_t *uring_create(char *testFileName, int flags, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  aiori_fd_t * fd = uring_register_fd(o, POSIX_Create(testFileName, flags, o->p));
+  alloc_slot_buffers(o);
+  return fd;
+}
+
+static void submit_pending(uring_options_t * o){
+  if(o->prepared == 0){
+    return;
+  }
+  int res = io_uring_submit(& o->ring);
+  if(res < 0){
+    ERRF("URING: submit failed: \"%s\"", strerror(-res));
+  }
+  o->prepared = 0;
+}
+
+/*
+ * Reap between min and max completed ops and return their slots to the ring.
+ * Completions of ops submitted with a tag are stored, the number of them is returned.
+ */
+static int reap_completions(uring_options_t * o, aiori_xfer_completion_t * completions, int min, int max){
+  if(max > o->in_flight){
+    max = o->in_flight;
+  }
+  if(max == 0){
+    return 0;
+  }
+  if(min > max){
+    min = max;
+  }
+  struct io_uring_cqe * cqes[max];
+  struct io_uring_cqe * cqe;
+  int ret;
+  if(min > 0){
+    ret = io_uring_wait_cqe_nr(& o->ring, & cqe, min);
+  }else{
+    ret = io_uring_peek_cqe(& o->ring, & cqe); /* drives the completion polling of iopoll */
+    if(ret == -EAGAIN){
+      return 0;
+    }
+  }
+  if(ret < 0){
+    ERRF("URING, error waiting for completions: %s", strerror(-ret));
+  }
+  int count = 0;
+  int num_events = io_uring_peek_batch_cqe(& o->ring, cqes, max);
+  for (int i = 0; i < num_events; i++) {
+    uring_slot_t * slot = (uring_slot_t*) io_uring_cqe_get_data(cqes[i]);
+    long res = cqes[i]->res;
+    if(slot->tag != NULL){
+      if(completions == NULL){
+        ERR("URING, completion of an asynchronous transfer cannot be returned");
+      }
+      completions[count].tag = slot->tag;
+      completions[count].amount = res;
+      count++;
+    }else if(res != slot->length){
+      ERRF("URING, IO incomplete: %s", res < 0 ? strerror(-res) : "short transfer");
+    }
+    o->free_slots[o->free_count++] = slot;
+  }
+  io_uring_cq_advance(& o->ring, num_events);
+  o->in_flight -= num_events;
+  return count;
+}
+
+/* complete all pending ops */
+static void complete_all(uring_options_t * o){
+  submit_pending(o);
+  while(o->in_flight > 0){
+    reap_completions(o, NULL, o->in_flight, o->in_flight);
+  }
+}
+
+/* called if we must make *some* progress */
+static void process_some(uring_options_t * o){
+  if(o->in_flight == 0){
+    return;
+  }
+  submit_pending(o);
+  int mn = o->in_flight < o->batch ? o->in_flight : o->batch;
+  reap_completions(o, NULL, mn, o->in_flight);
+}
+
+/*
+ * Queue an op using a free slot, slot_buffer is 1 if the buffer is the one of
+ * the slot, only these buffers are registered.
+ */
+static void prepare_slot(uring_options_t * o, int access, uring_fd_t * ufd, void * buffer, int slot_buffer, IOR_offset_t length, IOR_offset_t offset, void * tag){
+  uring_slot_t * slot = o->free_slots[--o->free_count];
+  slot->tag = tag;
+  slot->length = length;
+
+  struct io_uring_sqe * sqe = io_uring_get_sqe(& o->ring);
+  if(sqe == NULL){
+    /* the submission queue is full, it has as many entries as slots */
+    submit_pending(o);
+    sqe = io_uring_get_sqe(& o->ring);
+    if(sqe == NULL){
+      ERR("URING: no submission queue entry available");
+    }
+  }
+  int index = slot_buffer && o->fixed_buffers == 1 ? (int) (slot - o->slots) : -1;
+  if(access == WRITE){
+    if(index >= 0){
+      io_uring_prep_write_fixed(sqe, ufd->fd, buffer, length, offset, index);
+    }else{
+      io_uring_prep_write(sqe, ufd->fd, buffer, length, offset);
+    }
+  }else{
+    if(index >= 0){
+      io_uring_prep_read_fixed(sqe, ufd->fd, buffer, length, offset, index);
+    }else{
+      io_uring_prep_read(sqe, ufd->fd, buffer, length, offset);
+    }
+  }
+  if(ufd->fixed){
+    io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+  }
+  io_uring_sqe_set_data(sqe, slot);
+  o->prepared++;
+  o->in_flight++;
+
+  if(o->prepared == o->batch){
+    submit_pending(o);
+  }
+}
+
+/*
+ * Ops are completed asynchronously using the buffers of the ring, the data of
+ * the caller is copied for writes. Checks require the caller's buffer, thus they
+ * are completed before returning. So are transfers larger than the buffers of
+ * the slots, which are sized for the transfers of the timed phases, i.e., the
+ * untimed writes of randomPrefill.
+ */
+static IOR_offset_t uring_Xfer(int access, aiori_fd_t *fd, IOR_size_t * buffer,
+                               IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  uring_fd_t * ufd = (uring_fd_t*) fd;
+
+  if(access == WRITECHECK || access == READCHECK || length > o->slot_size){
+    while(o->free_count == 0){
+      process_some(o);
+    }
+    prepare_slot(o, access, ufd, buffer, 0, length, offset, NULL);
+    complete_all(o);
+    return length;
+  }
+
+  while(o->free_count == 0){
+    process_some(o);
+  }
+  uring_slot_t * slot = o->free_slots[o->free_count - 1];
+  if(access == WRITE){
+    memcpy(slot->buffer, buffer, length);
+  }
+  prepare_slot(o, access, ufd, slot->buffer, 1, length, offset, NULL);
+  return length;
+}
+
+static int uring_Xfer_submit(int access, aiori_fd_t *fd, IOR_size_t * buffer,
+                               IOR_offset_t length, IOR_offset_t offset, void * tag, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  uring_fd_t * ufd = (uring_fd_t*) fd;
+
+  if(o->free_count == 0){
+    ERRF("URING: more transfers in flight than uring.depth = %d, increase it to at least the queueDepth", o->depth);
+  }
+  prepare_slot(o, access, ufd, buffer, 0, length, offset, tag);
+  return 0;
+}
+
+static int uring_Xfer_poll(aiori_fd_t *fd, aiori_xfer_completion_t * completions, int max, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  return reap_completions(o, completions, 0, max);
+}
+
+static int uring_Xfer_wait(aiori_fd_t *fd, aiori_xfer_completion_t * completions, int min, int max, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  int count = 0;
+  submit_pending(o);
+  while(count < min && o->in_flight > 0){
+    count += reap_completions(o, completions + count, min - count, max - count);
+  }
+  return count;
+}
+
+static void uring_Close(aiori_fd_t *fd, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  uring_fd_t * ufd = (uring_fd_t*) fd;
+  complete_all(o);
+  if(ufd->fixed){
+    int unused = -1;
+    io_uring_register_files_update(& o->ring, ufd->fd, & unused, 1);
+    o->files[ufd->fd] = -1;
+  }
+  POSIX_Close(ufd->pfd, o->p);
+  free(ufd);
+}
+
+static void uring_Fsync(aiori_fd_t *fd, aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  complete_all(o);
+  uring_fd_t * ufd = (uring_fd_t*) fd;
+  POSIX_Fsync(ufd->pfd, o->p);
+}
+
+static void uring_Sync(aiori_mod_opt_t * param){
+  uring_options_t * o = (uring_options_t*) param;
+  complete_all(o);
+  POSIX_Sync((aiori_mod_opt_t*) o->p);
+}
+
+
+
+ior_aiori_t uring_aiori = {
+        .name = "URING",
+        .name_legacy = NULL,
+        .create = uring_create,
+        .get_options = uring_options,
+        .initialize = uring_initialize,
+        .finalize = uring_finalize,
+        .xfer_hints = uring_xfer_hints,
+        .fsync = uring_Fsync,
+        .open = uring_Open,
+        .xfer = uring_Xfer,
+        .xfer_submit = uring_Xfer_submit,
+        .xfer_poll = uring_Xfer_poll,
+        .xfer_wait = uring_Xfer_wait,
+        .close = uring_Close,
+        .sync = uring_Sync,
+        .check_params = uring_check_params,
+        .remove = POSIX_Delete,
+        .cache_control = POSIX_CacheControl,
+        .cache_residency = POSIX_CacheResidency,
+        .get_version = aiori_get_version,
+        .get_file_size = POSIX_GetFileSize,
+        .statfs = aiori_posix_statfs,
+        .mkdir = aiori_posix_mkdir,
+        .rmdir = aiori_posix_rmdir,
+        .access = aiori_posix_access,
+        .stat = aiori_posix_stat,
+        .enable_mdtest = true
+};
@@ -26,6 +26,14 @@
 #include "aiori-POSIX.h"
 
 /************************** O P T I O N S *****************************/
+/* one slot per op in flight, the ring of slots is preallocated */
+typedef struct aio_slot_t{
+  struct iocb iocb;
+  void * buffer; // aligned buffer owned by the slot, used by aio_Xfer()
+  void * tag; // tag of aio_Xfer_submit(), NULL for ops of aio_Xfer()
+  IOR_offset_t length;
+} aio_slot_t;
+
 typedef struct{
   aiori_mod_opt_t * p; // posix options
   int max_pending;
@@ -37,7 +45,10 @@ typedef struct{
   int iocbs_pos; // how many are pending in iocbs
 
   int in_flight; // total pending ops
-  IOR_offset_t pending_bytes; // track pending IO volume for error checking
+  aio_slot_t * slots; // ring of max_pending slots
+  aio_slot_t ** free_slots; // stack of unused slots
+  int free_count;
+  IOR_offset_t slot_size; // size of the buffers of the slots, 0 if not allocated
 } aio_options_t;
 
 option_help * aio_options(aiori_mod_opt_t ** init_backend_options, aiori_mod_opt_t * init_values){
@@ -84,16 +95,56 @@ static void aio_initialize(aiori_mod_opt_t * param){
   if(io_setup(o->max_pending, & o->ioctx) != 0){
     ERRF("Couldn't initialize io context %s", strerror(errno));
   }
-  printf("%d\n", (o->max_pending));
 
   o->iocbs = malloc(sizeof(struct iocb *) * o->granularity);
   o->iocbs_pos = 0;
   o->in_flight = 0;
+
+  o->slots = malloc(sizeof(aio_slot_t) * o->max_pending);
+  o->free_slots = malloc(sizeof(aio_slot_t *) * o->max_pending);
+  if(o->iocbs == NULL || o->slots == NULL || o->free_slots == NULL){
+    ERR("AIO: cannot allocate the ring of pending ops");
+  }
+  for(int i = 0; i < o->max_pending; i++){
+    o->slots[i].buffer = NULL;
+    o->free_slots[i] = & o->slots[i];
+  }
+  o->free_count = o->max_pending;
+  o->slot_size = 0;
+}
+
+static void free_slot_buffers(aio_options_t * o){
+  for(int i = 0; i < o->max_pending; i++){
+    if(o->slots[i].buffer){
+      aligned_buffer_free(o->slots[i].buffer, IOR_MEMORY_TYPE_CPU);
+      o->slots[i].buffer = NULL;
+    }
+  }
+  o->slot_size = 0;
+}
+
+static void complete_all(aio_options_t * o);
+
+/* allocate the buffers of the slots for the largest transfer, outside of the timed transfers */
+static void alloc_slot_buffers(aio_options_t * o){
+  if(o->slot_size >= hints->transferSize){
+    return;
+  }
+  complete_all(o);
+  free_slot_buffers(o);
+  for(int i = 0; i < o->max_pending; i++){
+    o->slots[i].buffer = aligned_buffer_alloc(hints->transferSize, IOR_MEMORY_TYPE_CPU);
+  }
+  o->slot_size = hints->transferSize;
 }
 
 static void aio_finalize(aiori_mod_opt_t * param){
   aio_options_t * o = (aio_options_t*) param;
   io_destroy(o->ioctx);
+  free_slot_buffers(o);
+  free(o->slots);
+  free(o->free_slots);
+  free(o->iocbs);
 }
 
 static int aio_check_params(aiori_mod_opt_t * param){
@@ -105,6 +156,9 @@ static int aio_check_params(aiori_mod_opt_t * param){
   if(o->granularity > o->max_pending){
     ERRF("AIO granularity must be < max-pending, is %d > %d", o->granularity, o->max_pending);
   }
+  if(hints && hints->queueDepth > o->max_pending){
+    ERRF("AIO max-pending must be >= queueDepth, is %d < %d", o->max_pending, hints->queueDepth);
+  }
   return 0;
 }
 
@@ -112,6 +166,7 @@ static aiori_fd_t *aio_Open(char *testFileName, int flags, aiori_mod_opt_t * par
   aio_options_t * o = (aio_options_t*) param;
   aio_fd_t * fd = malloc(sizeof(aio_fd_t));
   fd->pfd = POSIX_Open(testFileName, flags, o->p);
+  alloc_slot_buffers(o);
   return (aiori_fd_t*) fd;
 }
 
@@ -119,6 +174,7 @@ static aiori_fd_t *aio_create(char *testFileName, int flags, aiori_mod_opt_t * p
   aio_options_t * o = (aio_options_t*) param;
   aio_fd_t * fd = malloc(sizeof(aio_fd_t));
   fd->pfd = POSIX_Create(testFileName, flags, o->p);
+  alloc_slot_buffers(o);
   return (aiori_fd_t*) fd;
 }
 
@@ -139,26 +195,49 @@ static void submit_pending(aio_options_t * o){
   o->iocbs_pos = 0;
 }
 
-/* complete all pending ops */
-static void complete_all(aio_options_t * o){
-  submit_pending(o);
-
-  struct io_event events[o->in_flight];
+/*
+ * Reap between min and max completed ops and return their slots to the ring.
+ * Completions of ops submitted with a tag are stored, the number of them is returned.
+ */
+static int reap_completions(aio_options_t * o, aiori_xfer_completion_t * completions, int min, int max, struct timespec * timeout){
+  if(max > o->in_flight){
+    max = o->in_flight;
+  }
+  if(max == 0){
+    return 0;
+  }
+  struct io_event events[max];
   int num_events;
-  num_events = io_getevents(o->ioctx, o->in_flight, o->in_flight, events, NULL);
+  int count = 0;
+  num_events = io_getevents(o->ioctx, min < max ? min : max, max, events, timeout);
+  if(num_events < 0){
+    ERRF("AIO, error in io_getevents(): %s", strerror(-num_events));
+  }
   for (int i = 0; i < num_events; i++) {
-    struct io_event event = events[i];
-    if(event.res == -1){
+    aio_slot_t * slot = (aio_slot_t*) events[i].data;
+    long res = (long) events[i].res;
+    if(slot->tag != NULL){
+      if(completions == NULL){
+        ERR("AIO, completion of an asynchronous transfer cannot be returned");
+      }
+      completions[count].tag = slot->tag;
+      completions[count].amount = res;
+      count++;
+    }else if(res != slot->length){
       ERR("AIO, error in io_getevents(), IO incomplete!");
-    }else{
-      o->pending_bytes -= event.res;
     }
-    free(event.obj);
+    o->free_slots[o->free_count++] = slot;
   }
-  if(o->pending_bytes != 0){
-    ERRF("AIO, error in flushing data, pending bytes: %lld", o->pending_bytes);
+  o->in_flight -= num_events;
+  return count;
+}
+
+/* complete all pending ops */
+static void complete_all(aio_options_t * o){
+  submit_pending(o);
+  while(o->in_flight > 0){
+    reap_completions(o, NULL, o->in_flight, o->in_flight, NULL);
   }
-  o->in_flight = 0;
 }
 
 /* called if we must make *some* progress */
@@ -166,47 +245,90 @@ static void process_some(aio_options_t * o){
   if(o->in_flight == 0){
     return;
   }
-  struct io_event events[o->in_flight];
-  int num_events;
+  submit_pending(o);
   int mn = o->in_flight < o->granularity ? o->in_flight : o->granularity;
-  num_events = io_getevents(o->ioctx, mn, o->in_flight, events, NULL);
-  //printf("Completed: %d\n", num_events);
-  for (int i = 0; i < num_events; i++) {
-    struct io_event event = events[i];
-    if(event.res == -1){
-      ERR("AIO, error in io_getevents(), IO incomplete!");
-    }else{
-      o->pending_bytes -= event.res;
-    }
-    free(event.obj);
+  reap_completions(o, NULL, mn, o->in_flight, NULL);
+}
+
+/* queue an op using a free slot, the slot must be prepared by the caller */
+static aio_slot_t * prepare_slot(aio_options_t * o, int access, aio_fd_t * afd, void * buffer, IOR_offset_t length, IOR_offset_t offset, void * tag){
+  aio_slot_t * slot = o->free_slots[--o->free_count];
+  slot->tag = tag;
+  slot->length = length;
+  if(access == WRITE){
+    io_prep_pwrite(& slot->iocb, *(int*)afd->pfd, buffer, length, offset);
+  }else{
+    io_prep_pread(& slot->iocb,  *(int*)afd->pfd, buffer, length, offset);
   }
-  o->in_flight -= num_events;
+  slot->iocb.data = slot;
+  o->iocbs[o->iocbs_pos] = & slot->iocb;
+  o->iocbs_pos++;
+  o->in_flight++;
+
+  if(o->iocbs_pos == o->granularity){
+    submit_pending(o);
+  }
+  return slot;
 }
 
+/*
+ * Ops are completed asynchronously using the buffers of the ring, the data of
+ * the caller is copied for writes. Checks require the caller's buffer, thus they
+ * are completed before returning. So are transfers larger than the buffers of
+ * the slots, which are sized for the transfers of the timed phases, i.e., the
+ * untimed writes of randomPrefill.
+ */
 static IOR_offset_t aio_Xfer(int access, aiori_fd_t *fd, IOR_size_t * buffer,
                                IOR_offset_t length, IOR_offset_t offset, aiori_mod_opt_t * param){
   aio_options_t * o = (aio_options_t*) param;
   aio_fd_t * afd = (aio_fd_t*) fd;
 
-  if(o->in_flight >= o->max_pending){
-    process_some(o);
+  if(access == WRITECHECK || access == READCHECK || length > o->slot_size){
+    while(o->free_count == 0){
+      process_some(o);
+    }
+    prepare_slot(o, access, afd, buffer, length, offset, NULL);
+    complete_all(o);
+    return length;
   }
-  o->pending_bytes += length;
 
-  struct iocb * iocb = malloc(sizeof(struct iocb));
+  while(o->free_count == 0){
+    process_some(o);
+  }
+  aio_slot_t * slot = o->free_slots[o->free_count - 1];
   if(access == WRITE){
-    io_prep_pwrite(iocb, *(int*)afd->pfd, buffer, length, offset);
-  }else{
-    io_prep_pread(iocb,  *(int*)afd->pfd, buffer, length, offset);
+    memcpy(slot->buffer, buffer, length);
   }
-  o->iocbs[o->iocbs_pos] = iocb;
-  o->iocbs_pos++;
-  o->in_flight++;
+  prepare_slot(o, access, afd, slot->buffer, length, offset, NULL);
+  return length;
+}
 
-  if(o->iocbs_pos == o->granularity){
-    submit_pending(o);
+static int aio_Xfer_submit(int access, aiori_fd_t *fd, IOR_size_t * buffer,
+                               IOR_offset_t length, IOR_offset_t offset, void * tag, aiori_mod_opt_t * param){
+  aio_options_t * o = (aio_options_t*) param;
+  aio_fd_t * afd = (aio_fd_t*) fd;
+
+  if(o->free_count == 0){
+    ERRF("AIO: more transfers in flight than aio.max-pending = %d, increase it to at least the queueDepth", o->max_pending);
   }
-  return length;
+  prepare_slot(o, access, afd, buffer, length, offset, tag);
+  return 0;
+}
+
+static int aio_Xfer_poll(aiori_fd_t *fd, aiori_xfer_completion_t * completions, int max, aiori_mod_opt_t * param){
+  aio_options_t * o = (aio_options_t*) param;
+  struct timespec timeout = {0, 0};
+  return reap_completions(o, completions, 0, max, & timeout);
+}
+
+static int aio_Xfer_wait(aiori_fd_t *fd, aiori_xfer_completion_t * completions, int min, int max, aiori_mod_opt_t * param){
+  aio_options_t * o = (aio_options_t*) param;
+  int count = 0;
+  submit_pending(o);
+  while(count < min && o->in_flight > 0){
+    count += reap_completions(o, completions + count, min - count, max - count, NULL);
+  }
+  return count;
 }
 
 static void aio_Close(aiori_fd_t *fd, aiori_mod_opt_t * param){
@@ -242,10 +364,15 @@ ior_aiori_t aio_aiori = {
         .fsync = aio_Fsync,
         .open = aio_Open,
         .xfer = aio_Xfer,
+        .xfer_submit = aio_Xfer_submit,
+        .xfer_poll = aio_Xfer_poll,
+        .xfer_wait = aio_Xfer_wait,
         .close = aio_Close,
         .sync = aio_Sync,
         .check_params = aio_check_params,
         .remove = POSIX_Delete,
+        .cache_control = POSIX_CacheControl,
+        .cache_residency = POSIX_CacheResidency,
         .get_version = aiori_get_version,
         .get_file_size = POSIX_GetFileSize,
         .statfs = aiori_posix_statfs,
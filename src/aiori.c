@@ -45,6 +45,9 @@ ior_aiori_t *available_aiori[] = {
 #ifdef USE_AIO_AIORI
         &aio_aiori,
 #endif
+#ifdef USE_URING_AIORI
+        &uring_aiori,
+#endif
 #ifdef USE_PMDK_AIORI
         &pmdk_aiori,
 #endif
@@ -17,6 +17,7 @@
 
 #include <sys/stat.h>
 #include <stdbool.h>
+#include <mpi.h>
 
 #include "iordef.h"                                     /* IOR Definitions */
 #include "aiori-debug.h"
@@ -48,6 +49,10 @@
 #define IOR_IWOTH         0x0400  /* write permission: other */
 #define IOR_IXOTH         0x0800 /* execute permission: other */
 
+/* -- cache control operations -- */
+#define IOR_CACHE_DROP    0x01    /* write back and drop the cached data of the file */
+#define IOR_CACHE_SYNCFS  0x02    /* write back the file system holding the file */
+
 typedef struct ior_aiori_statfs {
         uint64_t f_bsize;
         uint64_t f_blocks;
@@ -63,6 +68,8 @@ typedef struct ior_aiori_statfs {
 typedef struct aiori_xfer_hint_t{
   int dryRun;                      /* do not perform any I/Os just run evtl. inputs print dummy output */
   int filePerProc;                 /* single file or file-per-process */
+  int ranksPerFile;                /* processes sharing a file if > 1, the files are shared by groups */
+  MPI_Comm fileComm;               /* with ranksPerFile, the processes that access the same file */
   int collective;                  /* collective I/O */
   int numTasks;                    /* number of tasks for test */
   int numNodes;                    /* number of nodes for test */
@@ -70,9 +77,13 @@ typedef struct aiori_xfer_hint_t{
   int fsyncPerWrite;               /* fsync() after each write */
   IOR_offset_t segmentCount;       /* number of segments (or HDF5 datasets) */
   IOR_offset_t blockSize;          /* contiguous bytes to write per task */
-  IOR_offset_t transferSize;       /* size of transfer in bytes */
+  IOR_offset_t transferSize;       /* size of transfer in bytes, the largest size if variableTransferSize */
+  int variableTransferSize;        /* transfers of a block have different sizes */
+  IOR_offset_t extentSize;         /* transfers are accessed as extents of this size with xferv(), 0 if not */
+  IOR_offset_t fileHole;           /* bytes between two extents in the file */
   IOR_offset_t expectedAggFileSize; /* calculated aggregate file size */
   int singleXferAttempt;           /* do not retry transfer if incomplete */
+  int queueDepth;                  /* max number of transfers in flight using xfer_submit() */
 } aiori_xfer_hint_t;
 
 /* this is a dummy structure to create some type safety */
@@ -84,6 +95,19 @@ typedef struct aiori_fd_t{
   void * dummy;
 } aiori_fd_t;
 
+/* an extent of a vectored transfer with xferv() */
+typedef struct aiori_xfer_extent_t{
+  void * buffer;
+  IOR_offset_t length;
+  IOR_offset_t offset;
+} aiori_xfer_extent_t;
+
+/* completion of an asynchronous transfer started with xfer_submit() */
+typedef struct aiori_xfer_completion_t{
+  void * tag;                      /* the tag provided to xfer_submit() */
+  IOR_offset_t amount;             /* bytes transferred, less than requested on error */
+} aiori_xfer_completion_t;
+
 typedef struct ior_aiori {
         char *name;
         char *name_legacy;
@@ -96,6 +120,33 @@ typedef struct ior_aiori {
         void (*xfer_hints)(aiori_xfer_hint_t * params);
         IOR_offset_t (*xfer)(int access, aiori_fd_t *, IOR_size_t *,
                              IOR_offset_t size, IOR_offset_t offset, aiori_mod_opt_t * module_options);
+        /*
+         Optional asynchronous transfers, used if queueDepth > 1.
+         xfer_submit() starts a transfer, the buffer must not be touched until the completion carrying the tag is returned.
+         xfer_poll() returns up to max completions without blocking, xfer_wait() blocks until at least min completions are available.
+         Both return the number of completions stored.
+        */
+        int (*xfer_submit)(int access, aiori_fd_t *, IOR_size_t *,
+                             IOR_offset_t size, IOR_offset_t offset, void * tag, aiori_mod_opt_t * module_options);
+        int (*xfer_poll)(aiori_fd_t *, aiori_xfer_completion_t * completions, int max, aiori_mod_opt_t * module_options);
+        int (*xfer_wait)(aiori_fd_t *, aiori_xfer_completion_t * completions, int min, int max, aiori_mod_opt_t * module_options);
+        /*
+         Optional vectored transfer of count extents with increasing file offsets in a single call, used if extentSize > 0.
+         Returns the number of bytes transferred.
+        */
+        IOR_offset_t (*xferv)(int access, aiori_fd_t *, aiori_xfer_extent_t * extents, int count, aiori_mod_opt_t * module_options);
+        /*
+         Optional control of the client cache, used by the cacheControl and cacheResidency options.
+         cache_control() applies the IOR_CACHE_* operations to the file.
+         cache_residency() stores the number of pages of the file held in the cache and returns the number of pages of the file, or -1.
+        */
+        void (*cache_control)(char *, int operations, aiori_mod_opt_t * module_options);
+        IOR_offset_t (*cache_residency)(char *, IOR_offset_t * resident, aiori_mod_opt_t * module_options);
+        /*
+         Optional preparation of the file before a WRITE or READ/READCHECK phase outside of its timed region, e.g., preallocation.
+         Called by all processes, returns 1 if the file was prepared, the time is then reported separately.
+        */
+        int (*prepare)(char *, int access, aiori_mod_opt_t * module_options);
         void (*close)(aiori_fd_t *, aiori_mod_opt_t * module_options);
         void (*remove)(char *, aiori_mod_opt_t * module_options);
         char* (*get_version)(void);
@@ -113,6 +164,7 @@ typedef struct ior_aiori {
         int (*check_params)(aiori_mod_opt_t *); /* check if the provided module_optionseters for the given test and the module options are correct, if they aren't print a message and exit(1) or return 1*/
         void (*sync)(aiori_mod_opt_t * ); /* synchronize every pending operation for this storage */
         bool enable_mdtest;
+        bool thread_safe; /* xfer() may be called concurrently on the same file handle, required for threadsPerRank > 1 */
 } ior_aiori_t;
 
 enum bench_type {
@@ -122,6 +174,7 @@ enum bench_type {
 
 extern ior_aiori_t dummy_aiori;
 extern ior_aiori_t aio_aiori;
+extern ior_aiori_t uring_aiori;
 extern ior_aiori_t daos_aiori;
 extern ior_aiori_t dfs_aiori;
 extern ior_aiori_t hdf5_aiori;
@@ -12,6 +12,7 @@ void ShowTestEnd(IOR_test_t *tptr);
 void ShowSetup(IOR_param_t *params);
 void PrintRepeatEnd();
 void PrintRepeatStart();
+void PrintIntervalSeries(IOR_test_t *test);
 
 void PrintShortSummary(IOR_test_t * test);
 void PrintLongSummaryAllTests(IOR_test_t *tests_head);
@@ -23,10 +24,10 @@ void PrintReducedResult(IOR_test_t *test, int access, double bw, double iops, do
 			double *diff_subset, double totalTime, int rep);
 void PrintTestEnds();
 void PrintTableHeader();
+IOR_point_t * GetResultPoint(IOR_results_t * results, int access);
+char * AccessName(int access);
 /* End of ior-output */
 
-IOR_offset_t *GetOffsetArrayRandom(IOR_param_t * test, int pretendRank, IOR_offset_t * out_count);
-
 struct results {
   double min;
   double max;
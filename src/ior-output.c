@@ -21,7 +21,7 @@ void PrintTableHeader(){
     fprintf(out_resultfile, "access    bw(MiB/s)  IOPS       Latency(s)  block(KiB) xfer(KiB)  open(s)    wr/rd(s)   close(s)   total(s)   iter\n");
     fprintf(out_resultfile, "------    ---------  ----       ----------  ---------- ---------  --------   --------   --------   --------   ----\n");
   }else if(outputFormat == OUTPUT_CSV){
-    fprintf(out_resultfile, "access,bw(MiB/s),IOPS,Latency,block(KiB),xfer(KiB),open(s),wr/rd(s),close(s),total(s),numTasks,iter\n");
+    fprintf(out_resultfile, "access,bw(MiB/s),IOPS,Latency,block(KiB),xfer(KiB),open(s),wr/rd(s),close(s),total(s),p50(us),p90(us),p99(us),p99.9(us),max(us),unique(MiB),numTasks,iter\n");
   }
 }
 
@@ -107,6 +107,68 @@ static void PrintKeyValDouble(char * key, double value){
 }
 
 
+/* percentiles of the transfer latency, reported in us */
+#define NB_LATENCY_PERCENTILES 5
+/*
+ * The results of an access, the checks are accounted to the operation they verify.
+ */
+IOR_point_t * GetResultPoint(IOR_results_t * results, int access){
+  switch(access){
+  case WRITE:
+  case WRITECHECK:
+    return & results->write;
+  case READ:
+  case READCHECK:
+    return & results->read;
+  case RWMIX:
+  case RWMIX_WRITE:
+    return & results->mixwrite;
+  case RWMIX_READ:
+    return & results->mixread;
+  }
+  ERRF("Unknown access %d", access);
+  return NULL;
+}
+
+char * AccessName(int access){
+  switch(access){
+  case WRITE:
+  case WRITECHECK:
+    return "write";
+  case READ:
+  case READCHECK:
+    return "read";
+  case RWMIX_WRITE:
+    return "mixwrite";
+  case RWMIX_READ:
+    return "mixread";
+  }
+  return "rwmix";
+}
+
+static const double latency_fractions[NB_LATENCY_PERCENTILES] = {0.5, 0.9, 0.99, 0.999, 1.0};
+static char * const latency_keys[NB_LATENCY_PERCENTILES] = {"latencyP50us", "latencyP90us", "latencyP99us", "latencyP999us", "latencyMaxus"};
+static char * const latency_names[NB_LATENCY_PERCENTILES] = {"p50(us)", "p90(us)", "p99(us)", "p99.9(us)", "max(us)"};
+
+static void PrintLatencyPercentiles(const LatencyHistogram * histogram){
+  for(int i=0; i < NB_LATENCY_PERCENTILES; i++){
+    double value = histogram ? LatencyHistogramPercentile(histogram, latency_fractions[i]) : 0;
+    PrintKeyValDouble(latency_keys[i], value * 1e6);
+  }
+}
+
+/* merge the histograms of all repetitions */
+static LatencyHistogram * LatencyHistogramOfTest(IOR_test_t *test, const int access){
+  LatencyHistogram * histogram = LatencyHistogramInit();
+  for(int i=0; i < test->params.repetitions; i++){
+    IOR_point_t *point = GetResultPoint(&test->results[i], access);
+    if(point->latencyHistogram){
+      LatencyHistogramMerge(histogram, point->latencyHistogram);
+    }
+  }
+  return histogram;
+}
+
 static void PrintKeyValInt(char * key, int64_t value){
   PrintNextToken();
   needNextToken = 1;
@@ -228,8 +290,9 @@ void PrintTestEnds(){
 
 void PrintReducedResult(IOR_test_t *test, int access, double bw, double iops, double latency,
 			double *diff_subset, double totalTime, int rep){
+  IOR_point_t *point = GetResultPoint(&test->results[rep], access);
   if (outputFormat == OUTPUT_DEFAULT){
-    fprintf(out_resultfile, "%-10s", access == WRITE ? "write" : "read");
+    fprintf(out_resultfile, "%-10s", AccessName(access));
     PPDouble(1, bw / MEBIBYTE, " ");
     PPDouble(1, iops, " ");
     PPDouble(1, latency, "  ");
@@ -242,7 +305,7 @@ void PrintReducedResult(IOR_test_t *test, int access, double bw, double iops, do
     fprintf(out_resultfile, "%-4d\n", rep);
   }else if (outputFormat == OUTPUT_JSON){
     PrintStartSection();
-    PrintKeyVal("access", access == WRITE ? "write" : "read");
+    PrintKeyVal("access", AccessName(access));
     PrintKeyValDouble("bwMiB", bw / MEBIBYTE);
     PrintKeyValDouble("blockKiB", (double)test->params.blockSize / KIBIBYTE);
     PrintKeyValDouble("xferKiB", (double)test->params.transferSize / KIBIBYTE);
@@ -252,9 +315,25 @@ void PrintReducedResult(IOR_test_t *test, int access, double bw, double iops, do
     PrintKeyValDouble("wrRdTime", diff_subset[1]);
     PrintKeyValDouble("closeTime", diff_subset[2]);
     PrintKeyValDouble("totalTime", totalTime);
+    PrintLatencyPercentiles(point->latencyHistogram);
+    PrintKeyValDouble("uniqueMiB", point->unique_bytes / MEBIBYTE);
+    if(point->intervalSamples){
+      PrintNamedArrayStart("intervals");
+      for(int i=0; i < IntervalSamplesCount(point->intervalSamples); i++){
+        double start, duration;
+        uint64_t bytes, ops;
+        IntervalSamplesGet(point->intervalSamples, i, & start, & duration, & bytes, & ops);
+        PrintStartSection();
+        PrintKeyValDouble("time", start);
+        PrintKeyValDouble("bwMiB", bytes / duration / MEBIBYTE);
+        PrintKeyValDouble("iops", ops / duration);
+        PrintEndSection();
+      }
+      PrintArrayEnd();
+    }
     PrintEndSection();
   }else if (outputFormat == OUTPUT_CSV){
-    PrintKeyVal("access", access == WRITE ? "write" : "read");
+    PrintKeyVal("access", AccessName(access));
     PrintKeyValDouble("bwMiB", bw / MEBIBYTE);
     PrintKeyValDouble("iops", iops);
     PrintKeyValDouble("latency", latency);
@@ -264,6 +343,8 @@ void PrintReducedResult(IOR_test_t *test, int access, double bw, double iops, do
     PrintKeyValDouble("wrRdTime", diff_subset[1]);
     PrintKeyValDouble("closeTime", diff_subset[2]);
     PrintKeyValDouble("totalTime", totalTime);
+    PrintLatencyPercentiles(point->latencyHistogram);
+    PrintKeyValDouble("uniqueMiB", point->unique_bytes / MEBIBYTE);
     PrintKeyValInt("Numtasks", test->params.numTasks);
     fprintf(out_resultfile, "%d\n", rep);
   }
@@ -271,6 +352,42 @@ void PrintReducedResult(IOR_test_t *test, int access, double bw, double iops, do
   fflush(out_resultfile);
 }
 
+static void PrintIntervalSeriesOneOperation(IOR_test_t *test, int access)
+{
+  for(int rep = 0; rep < test->params.repetitions; rep++){
+    IOR_point_t *point = GetResultPoint(&test->results[rep], access);
+    for(int i=0; point->intervalSamples && i < IntervalSamplesCount(point->intervalSamples); i++){
+      double start, duration;
+      uint64_t bytes, ops;
+      IntervalSamplesGet(point->intervalSamples, i, & start, & duration, & bytes, & ops);
+      fprintf(out_resultfile, "%s,%d,%.4f,%.4f,%.4f\n", AccessName(access), rep,
+              start, bytes / duration / MEBIBYTE, ops / duration);
+    }
+  }
+}
+
+/*
+ * The CSV time series of all iterations of a test, a table with its own header
+ * that follows the table of the results.
+ */
+void PrintIntervalSeries(IOR_test_t *test)
+{
+  IOR_param_t *params = &test->params;
+
+  if (rank != 0 || outputFormat != OUTPUT_CSV || params->sampleInterval <= 0)
+    return;
+  fprintf(out_resultfile, "\naccess,iter,time(s),bw(MiB/s),IOPS\n");
+  if (params->writeFile)
+    PrintIntervalSeriesOneOperation(test, WRITE);
+  if (params->rwmix > 0) {
+    PrintIntervalSeriesOneOperation(test, RWMIX_WRITE);
+    PrintIntervalSeriesOneOperation(test, RWMIX_READ);
+  }
+  if (params->readFile || params->checkRead)
+    PrintIntervalSeriesOneOperation(test, READ);
+  fflush(out_resultfile);
+}
+
 void PrintHeader(int argc, char **argv)
 {
         struct utsname unamebuf;
@@ -309,6 +426,12 @@ void PrintHeader(int argc, char **argv)
                 }
                 PrintKeyValEnd();
         }
+        double offset, error;
+        GetClockOffset(& offset, & error);
+        PrintKeyVal("Timer", GetClockSource());
+        PrintKeyValStart("Clock offset");
+        fprintf(out_resultfile, "max %.2f us to task 0 (residual error %.2f us)", offset * 1e6, error * 1e6);
+        PrintKeyValEnd();
         if (verbose >= VERBOSE_3) {     /* show env */
                 fprintf(out_logfile, "STARTING ENVIRON LOOP\n");
                 for (i = 0; environ[i] != NULL; i++) {
@@ -339,7 +462,7 @@ void ShowTestStart(IOR_param_t *test)
   ShowFileSystemSize(filename, test->backend, test->backend_options);
 
   if (verbose >= VERBOSE_3 || outputFormat == OUTPUT_JSON) {
-    char* data_packets[] = {"g","t","o","i"};
+    char* data_packets[] = {"t","o","i","r","d"};
 
     PrintNamedSectionStart("Parameters");
     PrintKeyValInt("testID", test->id);
@@ -349,6 +472,7 @@ void ShowTestStart(IOR_param_t *test)
     PrintKeyVal("testFileName", test->testFileName);
     PrintKeyValInt("deadlineForStonewall", test->deadlineForStonewalling);
     PrintKeyValInt("stoneWallingWearOut", test->stoneWallingWearOut);
+    PrintKeyValInt("stoneWallingAgreementInterval", test->stoneWallingAgreementInterval);
     PrintKeyValInt("maxTimeDuration", test->maxTimeDuration);
     PrintKeyValInt("outlierThreshold", test->outlierThreshold);
 
@@ -366,9 +490,26 @@ void ShowTestStart(IOR_param_t *test)
     PrintKeyValInt("useExistingTestFile", test->useExistingTestFile);
     PrintKeyValInt("uniqueDir", test->uniqueDir);
     PrintKeyValInt("singleXferAttempt", test->singleXferAttempt);
+    PrintKeyValInt("queueDepth", test->queueDepth);
+    PrintKeyValInt("threadsPerRank", test->threadsPerRank);
+    PrintKeyValInt("verifyThreads", test->verifyThreads);
+    PrintKeyVal("cacheControl", test->cacheControl ? test->cacheControl : "");
+    PrintKeyValInt("cacheResidency", test->cacheResidency);
+    PrintKeyValDouble("sampleInterval", test->sampleInterval);
+    PrintKeyVal("offsetDistribution", test->offsetDistribution ? test->offsetDistribution : "");
+    PrintKeyValInt("rwmix", test->rwmix);
+    PrintKeyVal("transferSizes", test->transferSizes ? test->transferSizes : "");
+    PrintKeyValInt("extentSize", test->extentSize);
+    PrintKeyValInt("fileHole", test->fileHole);
+    PrintKeyValInt("memoryHole", test->memoryHole);
+    PrintKeyVal("layout", test->layout ? test->layout : "");
+    PrintKeyValDouble("targetIOPS", test->targetIOPS);
+    PrintKeyValInt("targetBandwidth", test->targetBandwidth);
+    PrintKeyVal("targetArrivals", test->targetPoisson ? "poisson" : "constant");
     PrintKeyValInt("readFile", test->readFile);
     PrintKeyValInt("writeFile", test->writeFile);
     PrintKeyValInt("filePerProc", test->filePerProc);
+    PrintKeyValInt("ranksPerFile", test->ranksPerFile);
     PrintKeyValInt("reorderTasks", test->reorderTasks);
     PrintKeyValInt("reorderTasksRandom", test->reorderTasksRandom);
     PrintKeyValInt("reorderTasksRandomSeed", test->reorderTasksRandomSeed);
@@ -381,6 +522,10 @@ void ShowTestStart(IOR_param_t *test)
     PrintKeyValInt("warningAsErrors", test->warningAsErrors);
     PrintKeyValInt("verbose", verbose);
     PrintKeyVal("data packet type", data_packets[test->dataPacketType]);
+    if (test->dataPacketType == DATA_DEDUPE) {
+      PrintKeyValDouble("dedupeCompress", test->dedupeCompress);
+      PrintKeyValDouble("dedupeFraction", test->dedupeFraction);
+    }
     PrintKeyValInt("setTimeStampSignature/incompressibleSeed", test->setTimeStampSignature); /* Seed value was copied into setTimeStampSignature as well */
     PrintKeyValInt("collective", test->collective);
     PrintKeyValInt("segmentCount", test->segmentCount);
@@ -425,10 +570,19 @@ void ShowSetup(IOR_param_t *params)
   PrintKeyVal("api", params->api);
   PrintKeyVal("apiVersion", params->apiVersion);
   PrintKeyVal("test filename", params->testFileName);
-  PrintKeyVal("access", params->filePerProc ? "file-per-process" : "single-shared-file");
+  if(params->ranksPerFile > 1){
+    char access[64];
+    sprintf(access, "file-per-%d-processes", params->ranksPerFile);
+    PrintKeyVal("access", access);
+  }else{
+    PrintKeyVal("access", params->filePerProc ? "file-per-process" : "single-shared-file");
+  }
   PrintKeyVal("type", params->collective ? "collective" : "independent");
   PrintKeyValInt("segments", params->segmentCount);
   PrintKeyVal("ordering in a file", params->randomOffset ? "random" : "sequential");
+  if(params->offsetDistribution){
+    PrintKeyVal("offsetDistribution", params->offsetDistribution);
+  }
   if (params->reorderTasks == FALSE && params->reorderTasksRandom == FALSE) {
     PrintKeyVal("ordering inter file", "no tasks offsets");
   }
@@ -457,8 +611,46 @@ void ShowSetup(IOR_param_t *params)
 
   PrintKeyValInt("repetitions", params->repetitions);
   PrintKeyVal("xfersize", HumanReadable(params->transferSize, BASE_TWO));
+  if(params->transferSizes){
+    PrintKeyVal("transferSizes", params->transferSizes);
+  }
+  if(params->extentSize > 0){
+    PrintKeyVal("extentSize", HumanReadable(params->extentSize, BASE_TWO));
+    PrintKeyVal("fileHole", HumanReadable(params->fileHole, BASE_TWO));
+    PrintKeyVal("memoryHole", HumanReadable(params->memoryHole, BASE_TWO));
+  }
+  if(params->layout){
+    PrintKeyVal("layout", params->layout);
+  }
   PrintKeyVal("blocksize", HumanReadable(params->blockSize, BASE_TWO));
   PrintKeyVal("aggregate filesize", HumanReadable(params->expectedAggFileSize, BASE_TWO));
+  if(params->queueDepth > 1){
+    PrintKeyValInt("queueDepth", params->queueDepth);
+  }
+  if(params->verifyThreads > 0){
+    PrintKeyValInt("verifyThreads", params->verifyThreads);
+  }
+  if(params->cacheControl){
+    PrintKeyVal("cacheControl", params->cacheControl);
+  }
+  if(params->threadsPerRank > 1){
+    PrintKeyValInt("threadsPerRank", params->threadsPerRank);
+  }
+  if(params->sampleInterval > 0){
+    PrintKeyValDouble("sampleInterval", params->sampleInterval);
+  }
+  if(params->rwmix > 0){
+    PrintKeyValInt("rwmix", params->rwmix);
+  }
+  if(params->targetIOPS > 0){
+    PrintKeyValDouble("targetIOPS", params->targetIOPS);
+  }
+  if(params->targetBandwidth > 0){
+    PrintKeyVal("targetBandwidth", HumanReadable(params->targetBandwidth, BASE_TWO));
+  }
+  if(params->targetIOPS > 0 || params->targetBandwidth > 0){
+    PrintKeyVal("targetArrivals", params->targetPoisson ? "poisson" : "constant");
+  }
   if(params->dryRun){
     PrintKeyValInt("dryRun", params->dryRun);
   }
@@ -469,6 +661,9 @@ void ShowSetup(IOR_param_t *params)
   if (params->deadlineForStonewalling > 0) {
     PrintKeyValInt("stonewallingTime", params->deadlineForStonewalling);
     PrintKeyValInt("stoneWallingWearOut", params->stoneWallingWearOut );
+    if (params->collective) {
+      PrintKeyValInt("stoneWallingAgreementInterval", params->stoneWallingAgreementInterval);
+    }
   }
   PrintEndSection();
 
@@ -478,7 +673,7 @@ void ShowSetup(IOR_param_t *params)
 }
 
 static struct results *bw_ops_values(const int reps, IOR_results_t *measured,
-                                     IOR_offset_t transfer_size,
+                                     double transfer_size,
                                      const double *vals, const int access)
 {
         struct results *r;
@@ -491,8 +686,7 @@ static struct results *bw_ops_values(const int reps, IOR_results_t *measured,
         r->val = (double *)&r[1];
 
         for (i = 0; i < reps; i++, measured++) {
-                IOR_point_t *point = (access == WRITE) ? &measured->write :
-                                                         &measured->read;
+                IOR_point_t *point = GetResultPoint(measured, access);
 
                 r->val[i] = ((double) (point->aggFileSizeForBW))
                             / transfer_size / vals[i];
@@ -524,7 +718,7 @@ static struct results *bw_values(const int reps, IOR_results_t *measured,
 }
 
 static struct results *ops_values(const int reps, IOR_results_t *measured,
-                                  IOR_offset_t transfer_size,
+                                  double transfer_size,
                                   const double *vals, const int access)
 {
         return bw_ops_values(reps, measured, transfer_size, vals, access);
@@ -549,23 +743,24 @@ static void PrintLongSummaryOneOperation(IOR_test_t *test, const int access)
         double * times = malloc(sizeof(double)* reps);
         long long  stonewall_avg_data_accessed = 0;
         double stonewall_time = 0;
+        double unique_bytes = 0;
         for(int i=0; i < reps; i++){
-                IOR_point_t *point = (access == WRITE) ? &results[i].write :
-                                                         &results[i].read;
+                IOR_point_t *point = GetResultPoint(&results[i], access);
                 times[i] = point->time;
+                unique_bytes += point->unique_bytes / reps;
                 stonewall_time += point->stonewall_time;
                 stonewall_avg_data_accessed += point->stonewall_avg_data_accessed;
         }
 
         bw = bw_values(reps, results, times, access);
-        ops = ops_values(reps, results, params->transferSize, times, access);
-
-        IOR_point_t *point = (access == WRITE) ? &results[0].write :
-                                                 &results[0].read;
+        /* the mean size of the transfers with transferSizes */
+        ops = ops_values(reps, results, (double) params->blockSize / params->transfersPerBlock, times, access);
 
+        IOR_point_t *point = GetResultPoint(&results[0], access);
+        LatencyHistogram * latency = LatencyHistogramOfTest(test, access);
 
         if(outputFormat == OUTPUT_DEFAULT){
-          fprintf(out_resultfile, "%-9s ", access == WRITE ? "write" : "read");
+          fprintf(out_resultfile, "%-9s ", AccessName(access));
           fprintf(out_resultfile, "%10.2f ", bw->max / MEBIBYTE);
           fprintf(out_resultfile, "%10.2f ", bw->min / MEBIBYTE);
           fprintf(out_resultfile, "%10.2f ", bw->mean / MEBIBYTE);
@@ -597,10 +792,13 @@ static void PrintLongSummaryOneOperation(IOR_test_t *test, const int access)
           fprintf(out_resultfile, "%9.1f ", (float)point->aggFileSizeForBW / MEBIBYTE);
           fprintf(out_resultfile, "%3s ", params->api);
           fprintf(out_resultfile, "%6d", params->referenceNumber);
+          for (int i = 0; i < NB_LATENCY_PERCENTILES; i++)
+            fprintf(out_resultfile, " %9.2f", LatencyHistogramPercentile(latency, latency_fractions[i]) * 1e6);
+          fprintf(out_resultfile, " %11.1f", unique_bytes / MEBIBYTE);
           fprintf(out_resultfile, "\n");
         }else if (outputFormat == OUTPUT_JSON){
           PrintStartSection();
-          PrintKeyVal("operation", access == WRITE ? "write" : "read");
+          PrintKeyVal("operation", AccessName(access));
           PrintKeyVal("API", params->api);
           PrintKeyValInt("TestID", params->id);
           PrintKeyValInt("ReferenceNumber", params->referenceNumber);
@@ -629,6 +827,8 @@ static void PrintLongSummaryOneOperation(IOR_test_t *test, const int access)
             PrintKeyValDouble("StoneWallbwMeanMIB", stonewall_avg_data_accessed / stonewall_time / MEBIBYTE);
           }
           PrintKeyValDouble("xsizeMiB", (double) point->aggFileSizeForBW / MEBIBYTE);
+          PrintLatencyPercentiles(latency);
+          PrintKeyValDouble("uniqueMiBMean", unique_bytes / MEBIBYTE);
           PrintEndSection();
         }
 
@@ -637,6 +837,7 @@ static void PrintLongSummaryOneOperation(IOR_test_t *test, const int access)
         free(bw);
         free(ops);
         free(times);
+        LatencyHistogramFree(& latency);
 }
 
 void PrintLongSummaryOneTest(IOR_test_t *test)
@@ -645,6 +846,10 @@ void PrintLongSummaryOneTest(IOR_test_t *test)
 
         if (params->writeFile)
                 PrintLongSummaryOneOperation(test, WRITE);
+        if (params->rwmix > 0) {
+                PrintLongSummaryOneOperation(test, RWMIX_WRITE);
+                PrintLongSummaryOneOperation(test, RWMIX_READ);
+        }
         if (params->readFile || params->checkRead)
                 PrintLongSummaryOneOperation(test, READ);
 }
@@ -665,7 +870,11 @@ void PrintLongSummaryHeader()
         fprintf(out_resultfile, " Test# #Tasks tPN reps fPP reord reordoff reordrand seed"
                 " segcnt ");
         fprintf(out_resultfile, "%8s %8s %9s %5s", " blksiz", "xsize","aggs(MiB)", "API");
-        fprintf(out_resultfile, " RefNum\n");
+        fprintf(out_resultfile, " RefNum");
+        for (int i = 0; i < NB_LATENCY_PERCENTILES; i++)
+                fprintf(out_resultfile, " %9s", latency_names[i]);
+        fprintf(out_resultfile, " %11s", "unique(MiB)");
+        fprintf(out_resultfile, "\n");
 }
 
 void PrintLongSummaryAllTests(IOR_test_t *tests_head)
@@ -38,6 +38,7 @@
 #endif
 
 #include <assert.h>
+#include <pthread.h>
 
 #include "ior.h"
 #include "ior-internal.h"
@@ -62,6 +63,7 @@ static const ior_aiori_t *backend;
 
 static void DestroyTests(IOR_test_t *tests_head);
 static char *PrependDir(IOR_param_t *, char *);
+static int RanksPerFile(IOR_param_t *);
 static char **ParseFileName(char *, int *);
 static void InitTests(IOR_test_t *);
 static void TestIoSys(IOR_test_t *);
@@ -74,6 +76,7 @@ static void ior_set_xfer_hints(IOR_param_t * p){
   aiori_xfer_hint_t * hints = & p->hints;
   hints->dryRun = p->dryRun;
   hints->filePerProc = p->filePerProc;
+  hints->ranksPerFile = p->ranksPerFile;
   hints->collective = p->collective;
   hints->numTasks = p->numTasks;
   hints->numNodes = p->numNodes;
@@ -82,8 +85,16 @@ static void ior_set_xfer_hints(IOR_param_t * p){
   hints->segmentCount = p->segmentCount;
   hints->blockSize = p->blockSize;
   hints->transferSize = p->transferSize;
+  hints->variableTransferSize = p->transferSizes != NULL;
+  hints->extentSize = p->extentSize;
+  hints->fileHole = p->fileHole;
   hints->expectedAggFileSize = p->expectedAggFileSize;
+  if (p->extentSize > 0) {
+    /* the holes between the extents are part of the file */
+    hints->expectedAggFileSize = p->expectedAggFileSize / p->extentSize * (p->extentSize + p->fileHole);
+  }
   hints->singleXferAttempt = p->singleXferAttempt;
+  hints->queueDepth = p->queueDepth;
 
   if(backend->xfer_hints){
     backend->xfer_hints(hints);
@@ -265,6 +276,7 @@ void init_IOR_Param_t(IOR_param_t * p, MPI_Comm com)
         p->checkWrite = p->checkRead = FALSE;
         
         p->minTimeDuration = 0;
+        p->stoneWallingAgreementInterval = 16;
         
         /*
          * These can be overridden from the command-line but otherwise will be
@@ -284,6 +296,25 @@ void init_IOR_Param_t(IOR_param_t * p, MPI_Comm com)
         p->transferSize = 262144;
         p->randomSeed = -1;
         p->incompressibleSeed = 573;
+        p->dedupeCompress = 1.0;
+        p->queueDepth = 1;
+        p->threadsPerRank = 1;
+        p->verifyThreads = 0;
+        p->sampleInterval = 0;
+        p->targetIOPS = 0;
+        p->targetBandwidth = 0;
+        p->targetPoisson = 0;
+        p->rwmix = 0;
+        p->offsetDistribution = NULL;
+        p->transferSizes = NULL;
+        p->extentSize = 0;
+        p->fileHole = 0;
+        p->memoryHole = 0;
+        p->layout = NULL;
+        p->ranksPerFile = 0;
+        p->cacheControl = NULL;
+        p->cacheControlOps = 0;
+        p->cacheResidency = 0;
         p->testComm = com; // this com might change for smaller tests
         p->mpi_comm_world = com;
 
@@ -312,11 +343,7 @@ DisplayOutliers(int numTasks,
         var = var / numTasks;
         sd = sqrt(var);
 
-        if (access == WRITE) {
-                strcpy(accessString, "write");
-        } else {                /* READ */
-                strcpy(accessString, "read");
-        }
+        strcpy(accessString, AccessName(access));
         if (fabs(timerVal - mean) > (double)outlierThreshold) {
                 char hostname[MAX_STR];
                 int ret = gethostname(hostname, MAX_STR);
@@ -358,14 +385,16 @@ static void CheckFileSize(IOR_test_t *test, char * testFilename, IOR_offset_t da
 {
         IOR_param_t *params = &test->params;
         IOR_results_t *results = test->results;
-        IOR_point_t *point = (access == WRITE) ? &results[rep].write :
-                                                 &results[rep].read;
+        IOR_point_t *point = GetResultPoint(&results[rep], access);
 
         /* get the size of the file */
         IOR_offset_t aggFileSizeFromStat, tmpMin, tmpMax, tmpSum;
         aggFileSizeFromStat = backend->get_file_size(params->backend_options,  testFilename);
 
-        if (params->hints.filePerProc == TRUE) {
+        if (params->hints.filePerProc == TRUE || params->ranksPerFile > 1) {
+            /* count every file once */
+            if ((rank + rankOffset) % params->numTasks % RanksPerFile(params) != 0)
+                    aggFileSizeFromStat = 0;
             MPI_CHECK(MPI_Allreduce(&aggFileSizeFromStat, &tmpSum, 1,
                                     MPI_LONG_LONG_INT, MPI_SUM, testComm),
                       "cannot reduce total data moved");
@@ -395,7 +424,7 @@ static void CheckFileSize(IOR_test_t *test, char * testFilename, IOR_offset_t da
                 if (verbose >= VERBOSE_0 && rank == 0) {
                         if ((params->expectedAggFileSize
                              != point->aggFileSizeFromXfer)
-                            || (point->aggFileSizeFromStat
+                            || (params->fileHole == 0 && point->aggFileSizeFromStat
                                 != point->aggFileSizeFromXfer)) {
                                 WARNF("Expected aggregate file size       = %lld", (long long) params->expectedAggFileSize);
                                 WARNF("Stat() of aggregate file size      = %lld", (long long) point->aggFileSizeFromStat);
@@ -466,6 +495,16 @@ void AllocResults(IOR_test_t *test)
 void FreeResults(IOR_test_t *test)
 {
   if (test->results != NULL) {
+      for (int i = 0; i < test->params.repetitions; i++) {
+          LatencyHistogramFree(& test->results[i].write.latencyHistogram);
+          LatencyHistogramFree(& test->results[i].read.latencyHistogram);
+          IntervalSamplesFree(& test->results[i].write.intervalSamples);
+          IntervalSamplesFree(& test->results[i].read.intervalSamples);
+          LatencyHistogramFree(& test->results[i].mixwrite.latencyHistogram);
+          LatencyHistogramFree(& test->results[i].mixread.latencyHistogram);
+          IntervalSamplesFree(& test->results[i].mixwrite.intervalSamples);
+          IntervalSamplesFree(& test->results[i].mixread.intervalSamples);
+      }
       free(test->results);
   }
 }
@@ -628,10 +667,108 @@ static char **ParseFileName(char *name, int *count)
         return (fileNames);
 }
 
+/*
+ * Returns the number of processes that share a file, 1 for filePerProc.
+ */
+static int RanksPerFile(IOR_param_t * test)
+{
+        if (test->filePerProc)
+                return 1;
+        if (test->ranksPerFile > 1)
+                return test->ranksPerFile;
+        return test->numTasks;
+}
+
+/*
+ * Returns the file accessed by this process, with reordered tasks the file
+ * holding the data of the pretended rank.
+ */
+static int FileIndex(IOR_param_t * test)
+{
+        return ((rank + rankOffset) % test->numTasks) / RanksPerFile(test);
+}
+
+/*
+ * With ranksPerFile, split the processes into the groups that open the same
+ * file, the groups of a phase depend on rankOffset.
+ */
+static void FileCommSetup(IOR_param_t * test)
+{
+        if (test->ranksPerFile <= 1)
+                return;
+        if (test->hints.fileComm != MPI_COMM_NULL)
+                MPI_CHECK(MPI_Comm_free(& test->hints.fileComm), "cannot free communicator");
+        MPI_CHECK(MPI_Comm_split(testComm, FileIndex(test), rank, & test->hints.fileComm),
+                  "cannot split communicator of the files");
+}
+
+/*
+ * Let the backend prepare the file before a phase, e.g., preallocate it, and
+ * report the time of the slowest process outside of the timed phase.
+ */
+static void PrepareFile(IOR_param_t * test, char * testFileName, int access)
+{
+        if (backend->prepare == NULL)
+                return;
+        /* the files of the previous phase are removed or closed */
+        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+        double start = GetTimeStamp();
+        int prepared = backend->prepare(testFileName, access, test->backend_options);
+        double elapsed = GetTimeStamp() - start;
+        double maxElapsed;
+        int anyPrepared;
+        MPI_CHECK(MPI_Reduce(& elapsed, & maxElapsed, 1, MPI_DOUBLE, MPI_MAX, 0, testComm), "MPI_Reduce() failed");
+        MPI_CHECK(MPI_Reduce(& prepared, & anyPrepared, 1, MPI_INT, MPI_MAX, 0, testComm), "MPI_Reduce() failed");
+        if (rank == 0 && anyPrepared) {
+                fprintf(out_logfile, "Prepared the file(s) before %s in %.6f s\n",
+                        access == WRITE ? "write" : "read", maxElapsed);
+        }
+}
+
+/*
+ * Before a phase reading back the data, write back and drop the cached data of
+ * the file this process reads or flush its file system, and report how much of
+ * the files is still resident in the cache of the readers.
+ */
+static void CacheControl(IOR_param_t * test, char * testFileName)
+{
+        if (test->cacheControlOps == 0 && ! test->cacheResidency)
+                return;
+        /* all writers closed their files */
+        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+        if (test->cacheControlOps != 0)
+                backend->cache_control(testFileName, test->cacheControlOps, test->backend_options);
+        if (! test->cacheResidency)
+                return;
+
+        IOR_offset_t resident;
+        IOR_offset_t pages = backend->cache_residency(testFileName, & resident, test->backend_options);
+        double fraction = pages > 0 ? (double) resident / pages : 0;
+        double min, max, sum;
+        int valid = pages >= 0, validCount;
+        if (! valid)
+                fraction = 1;
+        MPI_CHECK(MPI_Reduce(& fraction, & min, 1, MPI_DOUBLE, MPI_MIN, 0, testComm), "MPI_Reduce() failed");
+        if (! valid)
+                fraction = 0;
+        MPI_CHECK(MPI_Reduce(& fraction, & max, 1, MPI_DOUBLE, MPI_MAX, 0, testComm), "MPI_Reduce() failed");
+        MPI_CHECK(MPI_Reduce(& fraction, & sum, 1, MPI_DOUBLE, MPI_SUM, 0, testComm), "MPI_Reduce() failed");
+        MPI_CHECK(MPI_Reduce(& valid, & validCount, 1, MPI_INT, MPI_SUM, 0, testComm), "MPI_Reduce() failed");
+        if (rank == 0) {
+                if (validCount == 0) {
+                        WARN("The cache residency of the test file(s) could not be sampled");
+                } else {
+                        fprintf(out_logfile, "Cached before %s: %.1f%% of the pages of the file(s) read by a process on average (min %.1f%%, max %.1f%%)\n",
+                                test->open == WRITECHECK ? "check" : "read",
+                                100.0 * sum / validCount, 100.0 * min, 100.0 * max);
+                }
+        }
+}
 
 /*
  * Return test file name to access.
- * for single shared file, fileNames[0] is returned in testFileName
+ * for single shared file, fileNames[0] is returned in testFileName,
+ * with ranksPerFile the files of the groups are numbered.
  */
 void GetTestFileName(char *testFileName, IOR_param_t * test)
 {
@@ -652,10 +789,8 @@ void GetTestFileName(char *testFileName, IOR_param_t * test)
         fileNames = ParseFileName(initialTestFileName, &count);
         if (count > 1 && test->uniqueDir == TRUE)
                 ERR("cannot use multiple file names with unique directories");
-        if (test->filePerProc) {
-                strcpy(testFileNameRoot,
-                       fileNames[((rank +
-                                   rankOffset) % test->numTasks) % count]);
+        if (test->filePerProc || test->ranksPerFile > 1) {
+                strcpy(testFileNameRoot, fileNames[FileIndex(test) % count]);
         } else {
                 strcpy(testFileNameRoot, fileNames[0]);
         }
@@ -672,6 +807,8 @@ void GetTestFileName(char *testFileName, IOR_param_t * test)
                 }
                 sprintf(testFileName, "%s.%08d", testFileNameRoot,
                         (rank + rankOffset) % test->numTasks);
+        } else if (test->ranksPerFile > 1) {
+                sprintf(testFileName, "%s.%08d", testFileNameRoot, FileIndex(test));
         } else {
                 strcpy(testFileName, testFileNameRoot);
         }
@@ -751,7 +888,7 @@ ReduceIterResults(IOR_test_t *test, double *timer, const int rep, const int acce
         int i;
         MPI_Op op;
 
-        assert(access == WRITE || access == READ);
+        assert(access == WRITE || access == READ || access == RWMIX_WRITE || access == RWMIX_READ);
 
         /* Find the minimum start time of the even numbered timers, and the
            maximum finish time for the odd numbered timers */
@@ -768,8 +905,7 @@ ReduceIterResults(IOR_test_t *test, double *timer, const int rep, const int acce
         totalTime = reduced[IOR_TIMER_CLOSE_STOP] - reduced[IOR_TIMER_OPEN_START];
         accessTime = reduced[IOR_TIMER_RDWR_STOP] - reduced[IOR_TIMER_RDWR_START];
 
-        IOR_point_t *point = (access == WRITE) ? &test->results[rep].write :
-                                                 &test->results[rep].read;
+        IOR_point_t *point = GetResultPoint(&test->results[rep], access);
 
         point->time = totalTime;
 
@@ -780,14 +916,14 @@ ReduceIterResults(IOR_test_t *test, double *timer, const int rep, const int acce
 
         /* For IOPS in this iteration, we divide the total amount of IOs from
          * all ranks over the entire access time (first start -> last end). */
-        iops = (point->aggFileSizeForBW / params->transferSize) / accessTime;
+        iops = ((double) point->aggFileSizeForBW * params->transfersPerBlock / params->blockSize) / accessTime;
 
         /* For Latency, we divide the total access time for each task over the
          * number of I/Os issued from that task; then reduce and display the
          * minimum (best) latency achieved. So what is reported is the average
          * latency of all ops from a single task, then taking the minimum of
          * that between all tasks. */
-        latency = (timer[IOR_TIMER_RDWR_STOP] - timer[IOR_TIMER_RDWR_START]) / (params->blockSize / params->transferSize);
+        latency = (timer[IOR_TIMER_RDWR_STOP] - timer[IOR_TIMER_RDWR_START]) / params->transfersPerBlock;
         MPI_CHECK(MPI_Reduce(&latency, &minlatency, 1, MPI_DOUBLE,
                              MPI_MIN, 0, testComm), "MPI_Reduce()");
 
@@ -823,6 +959,20 @@ static void RemoveFile(char *testFileName, int filePerProc, IOR_param_t * test)
                         rankOffset = tmpRankOffset;
                         GetTestFileName(testFileName, test);
                 }
+        } else if (test->ranksPerFile > 1) {
+                /* the first task of a group deletes the file of the group */
+                tmpRankOffset = rankOffset;
+                rankOffset = 0;
+                GetTestFileName(testFileName, test);
+                if ((rank % test->ranksPerFile == 0) && (backend->access(testFileName, F_OK, test->backend_options) == 0)) {
+                        if (verbose >= VERBOSE_3) {
+                                fprintf(out_logfile, "task %d removing %s\n", rank,
+                                        testFileName);
+                        }
+                        backend->remove(testFileName, test->backend_options);
+                }
+                rankOffset = tmpRankOffset;
+                GetTestFileName(testFileName, test);
         } else {
                 if ((rank == 0) && (backend->access(testFileName, F_OK, test->backend_options) == 0)) {
                         if (verbose >= VERBOSE_3) {
@@ -903,10 +1053,51 @@ static void InitTests(IOR_test_t *tests)
 /*
  * Setup transfer buffers, creating and filling as needed.
  */
+/*
+ * Returns the size of a transfer buffer, with memoryHole the buffer includes
+ * the holes after the extents.
+ */
+static size_t XferBufferSize(IOR_param_t * test)
+{
+        if (test->extentSize > 0)
+                return test->transferSize / test->extentSize * (test->extentSize + test->memoryHole);
+        return test->transferSize;
+}
+
+/*
+ * Returns the extents of a transfer if extentSize > 0, NULL otherwise.
+ */
+static aiori_xfer_extent_t * XferExtentsAlloc(IOR_param_t * test)
+{
+        if (test->extentSize == 0)
+                return NULL;
+        return safeMalloc(sizeof(aiori_xfer_extent_t) * (test->transferSize / test->extentSize));
+}
+
 static void XferBuffersSetup(IOR_io_buffers* ioBuffers, IOR_param_t* test,
                              int pretendRank)
 {
-        ioBuffers->buffer = aligned_buffer_alloc(test->transferSize, test->gpuMemoryFlags);
+        size_t size = XferBufferSize(test);
+
+        ioBuffers->buffer = aligned_buffer_alloc(size, test->gpuMemoryFlags);
+        ioBuffers->queueBuffers = NULL;
+        if (test->queueDepth > 1) {
+                ioBuffers->queueBuffers = safeMalloc(sizeof(void*) * test->queueDepth);
+                for (int i = 0; i < test->queueDepth; i++)
+                        ioBuffers->queueBuffers[i] = aligned_buffer_alloc(size, test->gpuMemoryFlags);
+        }
+        ioBuffers->threadBuffers = NULL;
+        if (test->threadsPerRank > 1) {
+                ioBuffers->threadBuffers = safeMalloc(sizeof(void*) * test->threadsPerRank);
+                for (int i = 0; i < test->threadsPerRank; i++)
+                        ioBuffers->threadBuffers[i] = aligned_buffer_alloc(size, test->gpuMemoryFlags);
+        }
+        ioBuffers->mixReadBuffer = NULL;
+        if (test->rwmix > 0) {
+                ioBuffers->mixReadBuffer = aligned_buffer_alloc(size, test->gpuMemoryFlags);
+        }
+        ioBuffers->extents = XferExtentsAlloc(test);
+        ioBuffers->verifyPool = NULL;
 }
 
 /*
@@ -916,6 +1107,137 @@ static void XferBuffersFree(IOR_io_buffers* ioBuffers, IOR_param_t* test)
 
 {
         aligned_buffer_free(ioBuffers->buffer, test->gpuMemoryFlags);
+        if (ioBuffers->queueBuffers) {
+                for (int i = 0; i < test->queueDepth; i++)
+                        aligned_buffer_free(ioBuffers->queueBuffers[i], test->gpuMemoryFlags);
+                free(ioBuffers->queueBuffers);
+        }
+        if (ioBuffers->threadBuffers) {
+                for (int i = 0; i < test->threadsPerRank; i++)
+                        aligned_buffer_free(ioBuffers->threadBuffers[i], test->gpuMemoryFlags);
+                free(ioBuffers->threadBuffers);
+        }
+        if (ioBuffers->mixReadBuffer) {
+                aligned_buffer_free(ioBuffers->mixReadBuffer, test->gpuMemoryFlags);
+        }
+        free(ioBuffers->extents);
+}
+
+/*
+ * With extentSize the data of a transfer is split into extents, extent i is
+ * stored at i * (extentSize + memoryHole) in the buffer and accessed at
+ * i * (extentSize + fileHole) in the file.  The data pattern of every extent
+ * is that of a transfer of extentSize bytes, thus the holes are never
+ * accessed and checked.
+ */
+static void GenerateMemoryPattern(IOR_param_t * test, void * buffer, int pretendRank)
+{
+        IOR_offset_t size = test->extentSize > 0 ? test->extentSize : test->transferSize;
+        IOR_offset_t stride = size + test->memoryHole;
+
+        for (IOR_offset_t pos = 0; pos < test->transferSize; pos += size)
+                generate_memory_pattern((char*) buffer + pos / size * stride, size, test->timeStampSignatureValue, pretendRank, test->dataPacketType, test->gpuMemoryFlags);
+}
+
+static void UpdateWriteMemoryPattern(IOR_param_t * test, void * buffer, IOR_offset_t transfer, IOR_offset_t offset, int pretendRank)
+{
+        if (test->extentSize == 0) {
+                update_write_memory_pattern(offset, buffer, transfer, test->timeStampSignatureValue, pretendRank, test->dataPacketType, test->gpuMemoryFlags);
+                return;
+        }
+        for (IOR_offset_t pos = 0; pos < transfer; pos += test->extentSize)
+                update_write_memory_pattern(offset + pos, (char*) buffer + pos / test->extentSize * (test->extentSize + test->memoryHole),
+                                            test->extentSize, test->timeStampSignatureValue, pretendRank, test->dataPacketType, test->gpuMemoryFlags);
+}
+
+static size_t CompareExtents(void * buffer, IOR_offset_t transfer, IOR_param_t * test, IOR_offset_t offset, int pretendRank, int access)
+{
+        size_t errors = 0;
+
+        if (test->extentSize == 0)
+                return CompareData(buffer, transfer, test, offset, pretendRank, access);
+        for (IOR_offset_t pos = 0; pos < transfer; pos += test->extentSize)
+                errors += CompareData((char*) buffer + pos / test->extentSize * (test->extentSize + test->memoryHole),
+                                      test->extentSize, test, offset + pos, pretendRank, access);
+        return errors;
+}
+
+/*
+ * Returns the offset in the file of the extent at offset of the IOR layout.
+ * With layout, the blocks of a segment are the sub-arrays of the processes
+ * and the extents are placed in the global array of the segment.
+ */
+static IOR_offset_t ExtentFileOffset(IOR_param_t * test, IOR_offset_t offset)
+{
+        if (test->arrayLayout) {
+                IOR_offset_t pos = offset % (test->blockSize * test->numTasks);
+                return offset - pos + array_layout_offset(test->arrayLayout, pos / test->blockSize, pos % test->blockSize);
+        }
+        return offset / test->extentSize * (test->extentSize + test->fileHole);
+}
+
+/*
+ * Access a transfer through the backend, with extentSize the extents are
+ * accessed with a single xferv() call or, if the backend does not provide
+ * it, one by one.
+ */
+static IOR_offset_t XferExtents(int access, aiori_fd_t * fd, void * buffer, IOR_offset_t transfer, IOR_offset_t offset, IOR_io_buffers * ioBuffers, IOR_param_t * test)
+{
+        aiori_xfer_extent_t * extents = ioBuffers->extents;
+        IOR_offset_t count;
+
+        if (test->extentSize == 0)
+                return backend->xfer(access, fd, buffer, transfer, offset, test->backend_options);
+        count = transfer / test->extentSize;
+        for (IOR_offset_t i = 0; i < count; i++) {
+                extents[i].buffer = (char*) buffer + i * (test->extentSize + test->memoryHole);
+                extents[i].length = test->extentSize;
+                extents[i].offset = ExtentFileOffset(test, offset + i * test->extentSize);
+        }
+        if (backend->xferv)
+                return backend->xferv(access, fd, extents, count, test->backend_options);
+
+        IOR_offset_t amtXferred = 0;
+        for (IOR_offset_t i = 0; i < count; i++) {
+                IOR_offset_t ret = backend->xfer(access, fd, extents[i].buffer, extents[i].length, extents[i].offset, test->backend_options);
+                if (ret != extents[i].length)
+                        return amtXferred;
+                amtXferred += ret;
+        }
+        return amtXferred;
+}
+
+/*
+ * Tile a block into transfers, with transferSizes the sizes are drawn from
+ * a fixed random sequence and the last transfer is truncated at the end of
+ * the block.  All blocks and processes use the same tiling, thus reads and
+ * checks access the extents that were written.
+ */
+static void TransferSizesInit(IOR_param_t * test)
+{
+        size_distribution_t sizes;
+        unsigned short seed[3] = {0x330e, 0x1234, 0xabcd};
+        IOR_offset_t pos = 0;
+        IOR_offset_t count = 0;
+
+        test->transferOffsets = NULL;
+        if (test->transferSizes == NULL) {
+                test->transfersPerBlock = test->blockSize / test->transferSize;
+                return;
+        }
+        size_distribution_parse(& sizes, test->transferSizes);
+        test->transferOffsets = safeMalloc(sizeof(IOR_offset_t) * (test->blockSize / sizes.min + 1));
+        while (pos < test->blockSize) {
+                IOR_offset_t size = size_distribution_get(& sizes, erand48(seed));
+                test->transferOffsets[count++] = pos;
+                pos += size < test->blockSize - pos ? size : test->blockSize - pos;
+        }
+        test->transferOffsets[count] = test->blockSize;
+        test->transfersPerBlock = count;
+        if (rank == 0 && verbose >= VERBOSE_1) {
+                fprintf(out_logfile, "%lld transfers per block with a mean size of %.1f KiB\n",
+                        (long long) count, (double) test->blockSize / count / KIBIBYTE);
+        }
 }
 
 
@@ -1112,12 +1434,12 @@ static void StoreRankInformation(IOR_test_t *test, double *timer, const int rep,
     MPI_Comm_size(params->testComm, & size);
     double *all_times = malloc(2* size * sizeof(double));
     MPI_Gather(times, 2, MPI_DOUBLE, all_times, 2, MPI_DOUBLE, 0, params->testComm);
-    IOR_point_t *point = (access == WRITE) ? &test->results[rep].write : &test->results[rep].read;
+    IOR_point_t *point = GetResultPoint(&test->results[rep], access);
     double file_size = ((double) point->aggFileSizeForBW) / size;
 
     for(int i=0; i < size; i++){
       char buff[1024];
-      sprintf(buff, "%s,%d,%.10e,%.10e,%.10e,%.10e\n", access==WRITE ? "write" : "read", i, all_times[i*2], all_times[i*2+1], file_size/all_times[i*2], file_size/all_times[i*2+1] );
+      sprintf(buff, "%s,%d,%.10e,%.10e,%.10e,%.10e\n", AccessName(access), i, all_times[i*2], all_times[i*2+1], file_size/all_times[i*2], file_size/all_times[i*2+1] );
       int ret = fwrite(buff, strlen(buff), 1, fd);
       if(ret != 1){
         WARN("Couln't append to saveRankPerformanceDetailsCSV file\n");
@@ -1186,7 +1508,14 @@ static void TestIoSys(IOR_test_t *test)
         }
 
         XferBuffersSetup(&ioBuffers, params, pretendRank);
-        
+        TransferSizesInit(params);
+        params->arrayLayout = NULL;
+        if (params->layout) {
+                params->arrayLayout = safeMalloc(sizeof(array_layout_t));
+                array_layout_parse(params->arrayLayout, params->layout);
+        }
+        params->hints.fileComm = MPI_COMM_NULL;
+
         /* Initial time stamp */
         startTime = GetTimeStamp();
 
@@ -1194,7 +1523,7 @@ static void TestIoSys(IOR_test_t *test)
         uint64_t params_saved_wearout = params->stoneWallingWearOutIterations;
 
         /* Check if the file exists and warn users */
-        if((params->writeFile || params->checkWrite) && (params->hints.filePerProc || rank == 0)){
+        if((params->writeFile || params->checkWrite) && (params->hints.filePerProc || rank % RanksPerFile(params) == 0)){
           struct stat sb;
           GetTestFileName(testFileName, params);
           int ret = backend->stat(testFileName, & sb, params->backend_options);
@@ -1229,7 +1558,12 @@ static void TestIoSys(IOR_test_t *test)
                           (&params->timeStampSignatureValue, 1, MPI_UNSIGNED, 0,
                            testComm), "cannot broadcast start time value");
 
-                generate_memory_pattern((char*) ioBuffers.buffer, params->transferSize, params->timeStampSignatureValue, pretendRank, params->dataPacketType, params->gpuMemoryFlags);
+                set_dedupe_pattern(params->dedupeCompress, params->dedupeFraction);
+                GenerateMemoryPattern(params, ioBuffers.buffer, pretendRank);
+                for (int i = 0; ioBuffers.queueBuffers && i < params->queueDepth; i++)
+                        GenerateMemoryPattern(params, ioBuffers.queueBuffers[i], pretendRank);
+                for (int i = 0; ioBuffers.threadBuffers && i < params->threadsPerRank; i++)
+                        GenerateMemoryPattern(params, ioBuffers.threadBuffers[i], pretendRank);
 
                 /* use repetition count for number of multiple files */
                 if (params->multiFile)
@@ -1252,6 +1586,8 @@ static void TestIoSys(IOR_test_t *test)
                         }
 
                         params->stoneWallingWearOutIterations = params_saved_wearout;
+                        FileCommSetup(params);
+                        PrepareFile(params, testFileName, WRITE);
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = WRITE;
                         timer[IOR_TIMER_OPEN_START] = GetTimeStamp();
@@ -1316,12 +1652,55 @@ static void TestIoSys(IOR_test_t *test)
                         
                         GetTestFileName(testFileName, params);
                         params->open = WRITECHECK;
+                        CacheControl(params, testFileName);
+                        FileCommSetup(params);
                         fd = backend->open(testFileName, IOR_RDONLY, params->backend_options);
                         if(fd == NULL) FAIL("Cannot open file");
                         dataMoved = WriteOrRead(params, rep, &results[rep], fd, WRITECHECK, &ioBuffers);
                         backend->close(fd, params->backend_options);
                         rankOffset = 0;
                 }
+                /*
+                 * mixed writes and reads of the file(s), the writes and reads are timed
+                 * together but accounted separately
+                 */
+                if (params->rwmix > 0 && !test_time_elapsed(params, startTime)) {
+                        GetTestFileName(testFileName, params);
+                        if (verbose >= VERBOSE_3) {
+                                fprintf(out_logfile, "task %d writing and reading %s\n", rank,
+                                        testFileName);
+                        }
+                        DelaySecs(params->interTestDelay);
+                        FileCommSetup(params);
+                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+                        params->open = RWMIX;
+                        timer[IOR_TIMER_OPEN_START] = GetTimeStamp();
+                        fd = backend->open(testFileName, IOR_RDWR, params->backend_options);
+                        if(fd == NULL) FAIL("Cannot open file");
+                        timer[IOR_TIMER_OPEN_STOP] = GetTimeStamp();
+                        if (params->intraTestBarriers)
+                                MPI_CHECK(MPI_Barrier(testComm),
+                                          "barrier error");
+                        if (rank == 0 && verbose >= VERBOSE_1) {
+                                fprintf(out_logfile,
+                                        "Commencing mixed write and read performance test: %s\n",
+                                        CurrentTimeString());
+                        }
+                        timer[IOR_TIMER_RDWR_START] = GetTimeStamp();
+                        dataMoved = WriteOrRead(params, rep, &results[rep], fd, RWMIX, &ioBuffers);
+                        timer[IOR_TIMER_RDWR_STOP] = GetTimeStamp();
+                        if (params->intraTestBarriers)
+                                MPI_CHECK(MPI_Barrier(testComm),
+                                          "barrier error");
+                        timer[IOR_TIMER_CLOSE_START] = GetTimeStamp();
+                        backend->close(fd, params->backend_options);
+                        timer[IOR_TIMER_CLOSE_STOP] = GetTimeStamp();
+                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+
+                        ProcessIterResults(test, timer, rep, RWMIX_WRITE);
+                        ProcessIterResults(test, timer, rep, RWMIX_READ);
+                }
+
                 /*
                  * read the file(s), getting timing between I/O calls
                  */
@@ -1351,8 +1730,7 @@ static void TestIoSys(IOR_test_t *test)
                         }
                         /* random process offset reading */
                         if (params->reorderTasksRandom) {
-                                /* this should not intefere with randomOffset within a file because GetOffsetArrayRandom */
-                                /* seeds every rand() call  */
+                                /* this does not intefere with randomOffset, its permutation does not use rand() */
                                 int nodeoffset;
                                 unsigned int iseed0;
                                 nodeoffset = params->taskPerNodeOffset;
@@ -1382,8 +1760,11 @@ static void TestIoSys(IOR_test_t *test)
                                         testFileName);
                         }
                         DelaySecs(params->interTestDelay);
-                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = READ;
+                        FileCommSetup(params);
+                        PrepareFile(params, testFileName, operation_flag);
+                        CacheControl(params, testFileName);
+                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         timer[IOR_TIMER_OPEN_START] = GetTimeStamp();
                         fd = backend->open(testFileName, IOR_RDONLY, params->backend_options);
                         if(fd == NULL) FAIL("Cannot open file");
@@ -1430,6 +1811,7 @@ static void TestIoSys(IOR_test_t *test)
 
         }
         PrintRepeatEnd();
+        PrintIntervalSeries(test);
 
         if (params->summary_every_test) {
                 PrintLongSummaryHeader();
@@ -1439,6 +1821,12 @@ static void TestIoSys(IOR_test_t *test)
         }
 
         XferBuffersFree(&ioBuffers, params);
+        free(params->transferOffsets);
+        params->transferOffsets = NULL;
+        free(params->arrayLayout);
+        params->arrayLayout = NULL;
+        if (params->hints.fileComm != MPI_COMM_NULL)
+                MPI_CHECK(MPI_Comm_free(& params->hints.fileComm), "cannot free communicator");
 
         if (hog_buf != NULL)
                 free(hog_buf);
@@ -1462,6 +1850,8 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
           ERR("the StoneWallingStatusFile is only sensible for a write test when using  stoneWallingWearOut");
         if (test->deadlineForStonewalling == 0 && test->stoneWallingWearOut > 0)
           ERR("the stoneWallingWearOut is only sensible when setting a stonewall deadline with -D");
+        if (test->stoneWallingAgreementInterval < 1)
+          ERR("stoneWallingAgreementInterval must be at least 1");
         if (test->stoneWallingStatusFile && test->testscripts)
           WARN("the StoneWallingStatusFile only preserves the last experiment, make sure that each run uses a separate status file!");
         if (test->repetitions <= 0)
@@ -1469,6 +1859,18 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
                            test, &defaults, repetitions);
         if (test->numTasks <= 0)
                 ERR("too few tasks for testing");
+        if (test->ranksPerFile < 0)
+                ERR("ranksPerFile must not be negative");
+        if (test->ranksPerFile > 0) {
+                if (test->numTasks % test->ranksPerFile != 0)
+                        ERR("the number of tasks must be a multiple of ranksPerFile");
+                /* one rank per file is file-per-process, all ranks share a single file */
+                test->filePerProc = test->ranksPerFile == 1;
+                if (test->ranksPerFile == 1 || test->ranksPerFile == test->numTasks)
+                        test->ranksPerFile = 0;
+        }
+        if (test->ranksPerFile > 1 && test->uniqueDir)
+                ERR("ranksPerFile is not available with uniqueDir");
         if (test->interTestDelay < 0)
                 WARN_RESET("inter-test delay must be nonnegative value",
                            test, &defaults, interTestDelay);
@@ -1479,6 +1881,38 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
                 ERR("using readCheck only requires to write a timeStampSignature -- use -G");
         if (test->segmentCount < 0)
                 ERR("segment count must be positive value");
+        if (test->layout) {
+                array_layout_t layout;
+                if (array_layout_parse(& layout, test->layout) != 0)
+                        ERR("layout must be Nd:DIMS:GRID[:ELEMENTSIZE[:BLOCKS]], e.g., 3d:1024x1024x512:8x8x4, the dimensions must be multiples of the grid times the blocks");
+                if (array_layout_processes(& layout) != test->numTasks)
+                        ERRF("the process grid of the layout needs %llu tasks", (unsigned long long) array_layout_processes(& layout));
+                if (test->filePerProc || test->ranksPerFile > 1)
+                        ERR("layout requires a single shared file");
+                if (test->fileHole > 0)
+                        ERR("layout is not available with fileHole");
+                IOR_offset_t run = array_layout_run_size(& layout);
+                if (test->extentSize == 0) {
+                        /* extents cover the runs of a transfer that are contiguous in the file */
+                        IOR_offset_t size = test->transferSize;
+                        if (test->transferSizes) {
+                                size_distribution_t sizes;
+                                if (size_distribution_parse(& sizes, test->transferSizes) == 0)
+                                        size = sizes.min;
+                        }
+                        test->extentSize = run;
+                        while (size != 0) {
+                                IOR_offset_t r = test->extentSize % size;
+                                test->extentSize = size;
+                                size = r;
+                        }
+                } else if (run % test->extentSize != 0) {
+                        ERRF("extentSize must divide the contiguous runs of %lld bytes of the layout", run);
+                }
+                /* the block of a process is its sub-array */
+                test->blockSize = array_layout_local_size(& layout);
+                test->expectedAggFileSize = test->blockSize * test->segmentCount * test->numTasks;
+        }
         if ((test->blockSize % sizeof(IOR_size_t)) != 0)
                 ERR("block size must be a multiple of access size");
         if (test->blockSize < 0)
@@ -1487,20 +1921,102 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
                 ERR("transfer size must be a multiple of access size");
         if (test->transferSize < 0)
                 ERR("transfer size must be non-negative integer");
-        if (test->transferSize == 0) {
+        if (test->transferSizes) {
+                size_distribution_t sizes;
+                if (size_distribution_parse(& sizes, test->transferSizes) != 0)
+                        ERR("transferSizes must be a list of multiples of the smallest size with optional weights, e.g., 4k:3+1m:1, or a range, e.g., 4k-4m");
+                if ((sizes.min % sizeof(IOR_size_t)) != 0)
+                        ERR("transfer sizes must be a multiple of access size");
+                if ((test->blockSize % sizes.min) != 0)
+                        ERR("block size must be a multiple of the smallest transfer size");
+                if (test->blockSize < sizes.min)
+                        ERR("block size must not be smaller than the smallest transfer size");
+                /* the buffers hold the largest transfer */
+                test->transferSize = sizes.max;
+        } else if (test->transferSize == 0) {
                 ERR("test will not complete with zero transfer size");
         } else {
                 if ((test->blockSize % test->transferSize) != 0)
                         ERR("block size must be a multiple of transfer size");
+                if (test->blockSize < test->transferSize)
+                        ERR("block size must not be smaller than transfer size");
         }
-        if (test->blockSize < test->transferSize)
-                ERR("block size must not be smaller than transfer size");
-        if (test->randomOffset && test->blockSize == test->transferSize)
+        if (test->randomOffset && ! test->transferSizes && test->blockSize == test->transferSize)
             ERR("IOR will randomize access within a block and repeats the same pattern for all segments, therefore choose blocksize > transferSize");
         if (! test->randomOffset && test->randomPrefillBlocksize)
           ERR("Setting the randomPrefill option without using random is not useful");
         if (test->randomPrefillBlocksize && (test->blockSize % test->randomPrefillBlocksize != 0))
           ERR("The randomPrefill option must divide the blockSize");
+        if (test->queueDepth < 1)
+          ERR("queueDepth must be at least 1");
+        if (test->queueDepth > 1 && test->collective)
+          ERR("queueDepth > 1 is not available with collective I/O");
+        if (test->queueDepth > 1 && test->fsyncPerWrite)
+          ERR("queueDepth > 1 is not available with fsyncPerWrite");
+        if (test->threadsPerRank < 1)
+          ERR("threadsPerRank must be at least 1");
+        if (test->verifyThreads < 0)
+          ERR("verifyThreads must not be negative");
+        if (test->verifyThreads > 0 && (test->queueDepth > 1 || test->threadsPerRank > 1))
+          ERR("verifyThreads is not available with queueDepth > 1 or threadsPerRank > 1");
+        if (test->sampleInterval < 0)
+          ERR("sampleInterval must not be negative");
+        if (test->targetIOPS < 0 || test->targetBandwidth < 0)
+          ERR("targetIOPS and targetBandwidth must not be negative");
+        if (test->targetIOPS > 0 && test->targetBandwidth > 0)
+          ERR("only one of targetIOPS and targetBandwidth can be set");
+        if ((test->targetIOPS > 0 || test->targetBandwidth > 0) && test->interIODelay > 0)
+          ERR("interIODelay cannot be combined with targetIOPS or targetBandwidth");
+        if (test->offsetDistribution) {
+          skewed_distribution_t dist;
+          if (skewed_distribution_parse(& dist, test->offsetDistribution) != 0)
+            ERR("offsetDistribution must be uniform, zipf:E, hotspot:D/A or pareto[:H]");
+          if (! test->randomOffset)
+            ERR("offsetDistribution requires random offsets (-z)");
+          if ((test->checkWrite || test->checkRead) && ! test->filePerProc)
+            ERR("offsetDistribution with a shared file cannot be verified as processes overwrite each others data");
+        }
+        if (test->extentSize < 0 || test->fileHole < 0 || test->memoryHole < 0)
+          ERR("extentSize, fileHole and memoryHole must not be negative");
+        if (test->extentSize == 0 && (test->fileHole > 0 || test->memoryHole > 0))
+          ERR("fileHole and memoryHole require extentSize");
+        if (test->extentSize > 0) {
+          if ((test->extentSize % sizeof(IOR_size_t)) != 0 || (test->fileHole % sizeof(IOR_size_t)) != 0
+              || (test->memoryHole % sizeof(IOR_size_t)) != 0)
+            ERR("extentSize, fileHole and memoryHole must be a multiple of access size");
+          if (test->transferSizes) {
+            size_distribution_t sizes;
+            size_distribution_parse(& sizes, test->transferSizes);
+            if ((sizes.min % test->extentSize) != 0)
+              ERR("the transfer sizes must be a multiple of extentSize");
+          } else if ((test->transferSize % test->extentSize) != 0) {
+            ERR("transfer size must be a multiple of extentSize");
+          }
+          if (test->queueDepth > 1)
+            ERR("extentSize is not available with queueDepth > 1");
+          if (test->randomPrefillBlocksize)
+            ERR("extentSize is not available with randomPrefill");
+        }
+        if (test->transferSizes && test->savePerOpDataCSV)
+          ERR("transferSizes is not available with savePerOpDataCSV");
+        if (test->rwmix < 0 || test->rwmix > 100)
+          ERR("rwmix must be a percentage between 0 and 100");
+        if (test->rwmix > 0 && (test->queueDepth > 1 || test->threadsPerRank > 1))
+          ERR("rwmix is not available with queueDepth > 1 or threadsPerRank > 1");
+        if (test->rwmix > 0 && test->collective)
+          ERR("rwmix is not available with collective I/O");
+        if (test->rwmix > 0 && (test->stoneWallingWearOut || test->stoneWallingWearOutIterations))
+          ERR("rwmix is not available with stoneWallingWearOut");
+        if (test->threadsPerRank > 1 && test->queueDepth > 1)
+          ERR("threadsPerRank > 1 cannot be combined with queueDepth > 1");
+        if (test->threadsPerRank > 1 && test->collective)
+          ERR("threadsPerRank > 1 is not available with collective I/O");
+        if (test->threadsPerRank > 1 && (test->stoneWallingWearOut || test->stoneWallingWearOutIterations))
+          ERR("threadsPerRank > 1 is not available with stoneWallingWearOut");
+        if (test->threadsPerRank > 1 && test->randomPrefillBlocksize)
+          ERR("threadsPerRank > 1 is not available with randomPrefill");
+        if (test->threadsPerRank > 1 && test->savePerOpDataCSV)
+          ERR("threadsPerRank > 1 is not available with savePerOpDataCSV");
         /* specific APIs */
         if ((strcasecmp(test->api, "MPIIO") == 0)
             && (test->blockSize < sizeof(IOR_size_t)
@@ -1520,6 +2036,7 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
             && (strcasecmp(test->api, "NCMPI") != 0)
             && (strcasecmp(test->api, "DUMMY") != 0)
             && (strcasecmp(test->api, "AIO") != 0)
+            && (strcasecmp(test->api, "URING") != 0)
             && (strcasecmp(test->api, "PMDK") != 0)
             && (strcasecmp(test->api, "MMAP") != 0)
             && (strcasecmp(test->api, "HDFS") != 0)
@@ -1544,10 +2061,38 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
                 ERR("random offset not available with HDF5");
         if ((strcasecmp(test->api, "NCMPI") == 0) && test->randomOffset)
                 ERR("random offset not available with NCMPI");
+        if (((strcasecmp(test->api, "HDF5") == 0) || (strcasecmp(test->api, "NCMPI") == 0)) && test->transferSizes)
+                ERRF("transferSizes not available with %s", test->api);
+        if ((strcasecmp(test->api, "NCMPI") == 0) && test->extentSize > 0)
+                ERR("extentSize not available with NCMPI");
         if ((strcasecmp(test->api, "NCMPI") == 0) && test->filePerProc)
                 ERR("file-per-proc not available in current NCMPI");
+        if (((strcasecmp(test->api, "HDF5") == 0) || (strcasecmp(test->api, "NCMPI") == 0)) && test->ranksPerFile > 1)
+                ERRF("ranksPerFile not available with %s", test->api);
 
         backend = test->backend;
+        if (test->queueDepth > 1 && (backend->xfer_submit == NULL || backend->xfer_wait == NULL))
+                ERRF("queueDepth > 1 requires asynchronous transfers which are not supported by the %s backend", backend->name);
+        if (test->threadsPerRank > 1 && ! backend->thread_safe)
+                ERRF("threadsPerRank > 1 requires a thread-safe backend, %s is not", backend->name);
+        test->cacheControlOps = 0;
+        if (test->cacheControl) {
+                char * spec = strdup(test->cacheControl);
+                char * saveptr;
+                for (char * op = strtok_r(spec, "+", & saveptr); op != NULL; op = strtok_r(NULL, "+", & saveptr)) {
+                        if (strcasecmp(op, "fadvise") == 0)
+                                test->cacheControlOps |= IOR_CACHE_DROP;
+                        else if (strcasecmp(op, "syncfs") == 0)
+                                test->cacheControlOps |= IOR_CACHE_SYNCFS;
+                        else if (strcasecmp(op, "none") != 0)
+                                ERRF("Unknown cacheControl operation \"%s\", use fadvise, syncfs or none", op);
+                }
+                free(spec);
+        }
+        if (test->cacheControlOps != 0 && backend->cache_control == NULL)
+                ERRF("cacheControl is not supported by the %s backend", backend->name);
+        if (test->cacheResidency && backend->cache_residency == NULL)
+                ERRF("cacheResidency is not supported by the %s backend", backend->name);
         ior_set_xfer_hints(test);
         /* allow the backend to validate the options */
         if(test->backend->check_params){
@@ -1558,106 +2103,335 @@ static void ValidateTests(IOR_param_t * test, MPI_Comm com)
         }
 }
 
+/*
+ * Random offsets for randomOffset, a permutation of the transfers that is
+ * either accessed in order or, with offsetDistribution, at skewed ranks.
+ */
+typedef struct {
+  random_permutation_t perm;
+  int skewed;
+  skewed_distribution_t distribution;
+} random_offsets_t;
+
 /**
- * Returns a precomputed array of IOR_offset_t for the inner benchmark loop.
- * They get created sequentially and mixed up in the end.
- * It should be noted that as the seeds get synchronised across all processes if not FilePerProcess is set
- * every process computes the same random order.
- * For a shared file all transfers get randomly assigned to ranks. The processes
- * can also have differen't numbers of transfers. This might lead to a bigger
- * diversion in accesse as it dose with filePerProc. This is expected but
- * should be mined.
- * @param test IOR_param_t for getting transferSize, blocksize and SegmentCount
+ * Sets up the random permutation of transfers used with randomOffset.
+ * No offset array is stored, GetOffset() computes the j-th offset on demand.
+ * With filePerProc every process permutes the transfers of its own block.
+ * For a shared file the seed is synchronized and all processes permute the
+ * n * numTasks transfers of a segment identically, with n = transfersPerBlock;
+ * process r accesses the indices [r * n, (r+1) * n) of the permutation,
+ * thus each transfer is accessed exactly once.  With ranksPerFile the
+ * processes of a group permute the transfers of their file and r is the
+ * rank within the group.
+ * With offsetDistribution the index of every transfer is instead drawn from
+ * the distribution, hence the most frequent ranks are scattered by the
+ * permutation and all processes of a shared file access the same hot data.
+ *
+ * @param test IOR_param_t for getting transferSize, blocksize and the seed
  * @param pretendRank int pretended Rank for shifting the offsets correctly
- * @return IOR_offset_t
+ * @param r the random offsets to initialize
  */
-IOR_offset_t *GetOffsetArrayRandom(IOR_param_t * test, int pretendRank, IOR_offset_t * out_count)
+static void RandomOffsetInit(IOR_param_t * test, int pretendRank, random_offsets_t * r)
 {
         int seed;
-        IOR_offset_t i;
-        IOR_offset_t offsets;
-        IOR_offset_t offsetCnt = 0;
-        IOR_offset_t *offsetArray;
+        IOR_offset_t transfers = test->transfersPerBlock;
 
-        if (test->filePerProc) {
-          /* set up seed, each process can determine which regions to access individually */
-          if (test->randomSeed == -1) {
-                  seed = time(NULL);
-                  test->randomSeed = seed;
-          } else {
-              seed = test->randomSeed + pretendRank;
-          }
-        }else{
-          /* Shared file requires that the seed is synchronized */
-          if (test->randomSeed == -1) {
-            // all processes need to have the same seed.
-            if(rank == 0){
-              seed = time(NULL);
-            }
-            MPI_CHECK(MPI_Bcast(& seed, 1, MPI_INT, 0, test->testComm), "cannot broadcast random seed value");
-            test->randomSeed = seed;
-          }else{
-            seed = test->randomSeed;
-          }
+        if (test->randomSeed == -1) {
+                /* all processes need to have the same seed to read back the data written */
+                if (rank == 0) {
+                        seed = time(NULL);
+                }
+                MPI_CHECK(MPI_Bcast(& seed, 1, MPI_INT, 0, test->testComm), "cannot broadcast random seed value");
+                test->randomSeed = seed;
         }
-        srandom(seed);
-
-        /* count needed offsets (pass 1) */
         if (test->filePerProc) {
-          offsets = test->blockSize / test->transferSize;
-        }else{
-          offsets = 0;
-          for (i = 0; i < test->blockSize * test->numTasks; i += test->transferSize) {
-            // this counts which process get how many transferes in the shared file
-            if ((rand() % test->numTasks) == pretendRank) {
-              offsets++;
-            }
-          }
+                /* each process can determine which regions to access individually */
+                random_permutation_init(& r->perm, transfers, test->randomSeed + pretendRank);
+        } else {
+                random_permutation_init(& r->perm, transfers * RanksPerFile(test), test->randomSeed);
         }
+        r->skewed = test->offsetDistribution != NULL;
+        if (r->skewed) {
+                skewed_distribution_parse(& r->distribution, test->offsetDistribution);
+                skewed_distribution_init(& r->distribution, r->perm.count, test->randomSeed + (test->filePerProc ? pretendRank : 0));
+        }
+}
 
-        /* setup empty array */
-        offsetArray = (IOR_offset_t *) safeMalloc(offsets * sizeof(IOR_offset_t));
-
-        *out_count = offsets;
+/*
+ * Returns the file offset of the j-th transfer of the segment for pretendRank
+ * and stores the size of the transfer in size.
+ */
+static IOR_offset_t GetOffset(IOR_param_t * test, random_offsets_t * r, int pretendRank, IOR_offset_t segment, IOR_offset_t j, IOR_offset_t * size)
+{
+        IOR_offset_t transfers = test->transfersPerBlock;
+        IOR_offset_t ranks = RanksPerFile(test);
+        IOR_offset_t item;              /* transfer within the blocks of the segment */
+        IOR_offset_t offset;
 
-        if (test->filePerProc) {
-            /* fill array */
-            for (i = 0; i < offsets; i++) {
-                offsetArray[i] = i * test->transferSize;
-            }
-        } else {
-            /* fill with offsets (pass 2) */
-            srandom(seed);  /* need same seed to get same transfers as counted in the beginning*/
-            for (i = 0; i < test->blockSize * test->numTasks; i += test->transferSize) {
-                if ((rand() % test->numTasks) == pretendRank) {
-                    offsetArray[offsetCnt] = i;
-                    offsetCnt++;
+        /* the block of the process within a segment of its file */
+        item = (pretendRank % ranks) * transfers + j;
+        if (test->randomOffset) {
+                uint64_t index = item;
+                if (r->skewed) {
+                        /* every process, segment and transfer has its own draw */
+                        uint64_t draw = segment * transfers * ranks + index;
+                        index = skewed_distribution_get(& r->distribution, draw);
                 }
-            }
+                item = random_permutation_get(& r->perm, index);
         }
-        /* reorder array */
-        for (i = 0; i < offsets; i++) {
-                IOR_offset_t value, tmp;
-                value = rand() % offsets;
-                tmp = offsetArray[value];
-                offsetArray[value] = offsetArray[i];
-                offsetArray[i] = tmp;
+        if (test->transferOffsets) {
+                IOR_offset_t * extent = & test->transferOffsets[item % transfers];
+                offset = item / transfers * test->blockSize + extent[0];
+                *size = extent[1] - extent[0];
+        } else {
+                offset = item * test->transferSize;
+                *size = test->transferSize;
         }
+        return offset + segment * ranks * test->blockSize;
+}
+
+/*
+ * Open loop schedule of the start times of transfers for targetIOPS and
+ * targetBandwidth, a transfer starts at its scheduled time regardless of the
+ * completion of previous transfers.
+ */
+typedef struct {
+  double interval;                 /* mean time between the starts of two transfers */
+  int poisson;                     /* exponentially distributed intervals */
+  double next;                     /* scheduled start of the next transfer */
+  unsigned short seed[3];
+} xfer_schedule_t;
+
+/*
+ * Initialize the schedule of one of streams independent streams that share the
+ * target rate, e.g., the threads of all processes.
+ */
+static void XferScheduleInit(xfer_schedule_t * s, IOR_param_t * test, double start, int streams, int stream){
+  double rate = test->targetIOPS;
+  if (test->targetBandwidth > 0)
+    rate = (double) test->targetBandwidth * test->transfersPerBlock / test->blockSize;
+  s->interval = streams / rate;
+  s->poisson = test->targetPoisson;
+  s->seed[0] = 0x330e;
+  s->seed[1] = stream;
+  s->seed[2] = stream >> 16;
+  if (s->poisson){
+    s->next = start - s->interval * log(1.0 - erand48(s->seed));
+  }else{
+    /* spread the streams across the interval */
+    s->next = start + s->interval * stream / streams;
+  }
+}
+
+/* time before a scheduled start spent polling the clock instead of sleeping */
+#define XFER_SCHEDULE_SPIN 0.0002
+
+/*
+ * Wait until the scheduled start of the next transfer and return it, if the
+ * transfers are behind schedule return immediately.
+ * The wake-up latency of nanosleep() would be accounted as latency of the
+ * transfer, thus the last part of the wait polls the clock.
+ */
+static double XferScheduleNext(xfer_schedule_t * s){
+  double start = s->next;
+  double delay = start - GetTimeStamp() - XFER_SCHEDULE_SPIN;
+  if (delay > 0){
+    struct timespec wait = {(time_t) delay, (long) ((delay - (time_t) delay) * 1e9)};
+    nanosleep(& wait, NULL);
+  }
+  while (GetTimeStamp() < start);
+  if (s->poisson){
+    s->next -= s->interval * log(1.0 - erand48(s->seed));
+  }else{
+    s->next += s->interval;
+  }
+  return start;
+}
+
+/*
+ * Accounting of the transfers of a phase, the members are optional.
+ */
+typedef struct {
+  double startTime;                /* start of the phase */
+  xfer_schedule_t * schedule;      /* start times of an open loop phase */
+  OpTimer * ot;                    /* per operation data for savePerOpDataCSV */
+  LatencyHistogram * latency;
+  IntervalSamples * samples;       /* throughput over time for sampleInterval */
+  double samplesOrigin;            /* start of the phase of the earliest process */
+  UniqueCounter * unique;          /* distinct transfers accessed */
+  uint64_t uniqueKey;              /* distinguishes the files of filePerProc or ranksPerFile */
+} xfer_stats_t;
+
+static void XferStatsRecord(xfer_stats_t * stats, double start, double end, IOR_offset_t offset, IOR_offset_t bytes){
+  if (stats == NULL)
+    return;
+  if(stats->ot) OpTimerValue(stats->ot, start - stats->startTime, end - start);
+  LatencyHistogramValue(stats->latency, end - start);
+  IntervalSamplesValue(stats->samples, end, bytes);
+  UniqueCounterValue(stats->unique, offset + stats->uniqueKey);
+}
+
+/*
+ * Returns the start time of a transfer, with a target rate this is the
+ * scheduled time so the latency includes the time the transfer is late.
+ */
+static double XferStatsStart(xfer_stats_t * stats){
+  if (stats == NULL || stats->schedule == NULL)
+    return GetTimeStamp();
+  return XferScheduleNext(stats->schedule);
+}
+
+/*
+ * Verification of the checked transfers by verifyThreads threads while the
+ * next transfers are read.  The buffers cycle between the reader and the
+ * threads: a filled buffer is queued for verification and the reader
+ * continues with a free one, waiting only if all buffers are queued.
+ */
+typedef struct {
+  void * buffer;
+  IOR_offset_t offset;
+  IOR_offset_t transfer;
+  int pretendRank;
+  int access;
+} verify_job_t;
+
+typedef struct verify_pool {
+  IOR_param_t * test;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;             /* signals queued jobs, free buffers and the shutdown */
+  int count;                       /* number of buffers */
+  void ** buffers;
+  void ** free_buffers;            /* stack of unused buffers */
+  int free_count;
+  verify_job_t * jobs;             /* ring of queued jobs */
+  int first_job;
+  int job_count;
+  int shutdown;
+  size_t errors;
+  int thread_count;
+  pthread_t * threads;
+} verify_pool_t;
+
+static void * VerifyThread(void * arg){
+  verify_pool_t * p = (verify_pool_t*) arg;
+
+  pthread_mutex_lock(& p->lock);
+  while (1){
+    while (p->job_count == 0 && ! p->shutdown)
+      pthread_cond_wait(& p->cond, & p->lock);
+    if (p->job_count == 0)
+      break;
+    verify_job_t job = p->jobs[p->first_job];
+    p->first_job = (p->first_job + 1) % p->count;
+    p->job_count--;
+    pthread_mutex_unlock(& p->lock);
+
+    size_t errors = CompareExtents(job.buffer, job.transfer, p->test, job.offset, job.pretendRank, job.access);
+
+    pthread_mutex_lock(& p->lock);
+    p->errors += errors;
+    p->free_buffers[p->free_count++] = job.buffer;
+    pthread_cond_broadcast(& p->cond);
+  }
+  pthread_mutex_unlock(& p->lock);
+  return NULL;
+}
+
+/*
+ * Start the threads, every thread owns two buffers to allow reading ahead.
+ */
+static verify_pool_t * VerifyPoolInit(IOR_param_t * test){
+  verify_pool_t * p = safeMalloc(sizeof(verify_pool_t));
+  p->test = test;
+  pthread_mutex_init(& p->lock, NULL);
+  pthread_cond_init(& p->cond, NULL);
+  p->count = 2 * test->verifyThreads;
+  p->buffers = safeMalloc(sizeof(void*) * p->count);
+  p->free_buffers = safeMalloc(sizeof(void*) * p->count);
+  p->jobs = safeMalloc(sizeof(verify_job_t) * p->count);
+  for (int i = 0; i < p->count; i++){
+    p->buffers[i] = aligned_buffer_alloc(XferBufferSize(test), test->gpuMemoryFlags);
+    p->free_buffers[i] = p->buffers[i];
+  }
+  p->free_count = p->count;
+  p->first_job = 0;
+  p->job_count = 0;
+  p->shutdown = 0;
+  p->errors = 0;
+  p->thread_count = test->verifyThreads;
+  p->threads = safeMalloc(sizeof(pthread_t) * p->thread_count);
+  for (int i = 0; i < p->thread_count; i++){
+    int ret = pthread_create(& p->threads[i], NULL, VerifyThread, p);
+    if (ret != 0)
+      ERRF("pthread_create() failed: %s", strerror(ret));
+  }
+  return p;
+}
 
-        return (offsetArray);
+/*
+ * Returns a buffer to read a transfer into, waits until one is verified if necessary.
+ */
+static void * VerifyPoolBuffer(verify_pool_t * p){
+  pthread_mutex_lock(& p->lock);
+  while (p->free_count == 0)
+    pthread_cond_wait(& p->cond, & p->lock);
+  void * buffer = p->free_buffers[--p->free_count];
+  pthread_mutex_unlock(& p->lock);
+  return buffer;
+}
+
+static void VerifyPoolSubmit(verify_pool_t * p, void * buffer, IOR_offset_t offset, IOR_offset_t transfer, int pretendRank, int access){
+  pthread_mutex_lock(& p->lock);
+  verify_job_t * job = & p->jobs[(p->first_job + p->job_count) % p->count];
+  job->buffer = buffer;
+  job->offset = offset;
+  job->transfer = transfer;
+  job->pretendRank = pretendRank;
+  job->access = access;
+  p->job_count++;
+  pthread_cond_broadcast(& p->cond);
+  pthread_mutex_unlock(& p->lock);
 }
 
-static IOR_offset_t WriteOrReadSingle(IOR_offset_t offset, int pretendRank, IOR_offset_t transfer, int * errors, IOR_param_t * test, aiori_fd_t * fd, IOR_io_buffers* ioBuffers, int access, OpTimer* ot, double startTime){
+/*
+ * Wait for the queued verifications and stop the threads, returns the number of errors.
+ */
+static size_t VerifyPoolFinish(verify_pool_t * p){
+  size_t errors;
+
+  pthread_mutex_lock(& p->lock);
+  p->shutdown = 1;
+  pthread_cond_broadcast(& p->cond);
+  pthread_mutex_unlock(& p->lock);
+  for (int i = 0; i < p->thread_count; i++){
+    int ret = pthread_join(p->threads[i], NULL);
+    if (ret != 0)
+      ERRF("pthread_join() failed: %s", strerror(ret));
+  }
+  for (int i = 0; i < p->count; i++)
+    aligned_buffer_free(p->buffers[i], p->test->gpuMemoryFlags);
+  errors = p->errors;
+  pthread_mutex_destroy(& p->lock);
+  pthread_cond_destroy(& p->cond);
+  free(p->buffers);
+  free(p->free_buffers);
+  free(p->jobs);
+  free(p->threads);
+  free(p);
+  return errors;
+}
+
+static IOR_offset_t WriteOrReadSingle(IOR_offset_t offset, int pretendRank, IOR_offset_t transfer, int * errors, IOR_param_t * test, aiori_fd_t * fd, IOR_io_buffers* ioBuffers, int access, xfer_stats_t * stats){
   IOR_offset_t amtXferred = 0;
 
   void *buffer = ioBuffers->buffer;
   if (access == WRITE) {
           /* fills each transfer with a unique pattern
            * containing the offset into the file */
-          update_write_memory_pattern(offset, ioBuffers->buffer, transfer, test->setTimeStampSignature, pretendRank, test->dataPacketType, test->gpuMemoryFlags);
-          double start = GetTimeStamp();
-          amtXferred = backend->xfer(access, fd, buffer, transfer, offset, test->backend_options);
-          if(ot) OpTimerValue(ot, start - startTime, GetTimeStamp() - start);
+          UpdateWriteMemoryPattern(test, ioBuffers->buffer, transfer, offset, pretendRank);
+          double start = XferStatsStart(stats);
+          amtXferred = XferExtents(access, fd, buffer, transfer, offset, ioBuffers, test);
+          XferStatsRecord(stats, start, GetTimeStamp(), offset, amtXferred);
           if (amtXferred != transfer)
                   ERR("cannot write to file");
           if (test->fsyncPerWrite)
@@ -1667,9 +2441,9 @@ static IOR_offset_t WriteOrReadSingle(IOR_offset_t offset, int pretendRank, IOR_
             nanosleep( & wait, NULL);
           }
   } else if (access == READ) {
-          double start = GetTimeStamp();
-          amtXferred = backend->xfer(access, fd, buffer, transfer, offset, test->backend_options);
-          if(ot) OpTimerValue(ot, start - startTime, GetTimeStamp() - start);
+          double start = XferStatsStart(stats);
+          amtXferred = XferExtents(access, fd, buffer, transfer, offset, ioBuffers, test);
+          XferStatsRecord(stats, start, GetTimeStamp(), offset, amtXferred);
           if (amtXferred != transfer)
                   ERR("cannot read from file");
           if (test->interIODelay > 0){
@@ -1677,26 +2451,356 @@ static IOR_offset_t WriteOrReadSingle(IOR_offset_t offset, int pretendRank, IOR_
             nanosleep( & wait, NULL);
           }
   } else if (access == WRITECHECK) {
+          if (ioBuffers->verifyPool)
+                  buffer = VerifyPoolBuffer(ioBuffers->verifyPool);
           invalidate_buffer_pattern(buffer, transfer, test->gpuMemoryFlags);
-          double start = GetTimeStamp();
-          amtXferred = backend->xfer(access, fd, buffer, transfer, offset, test->backend_options);
-          if(ot) OpTimerValue(ot, start - startTime, GetTimeStamp() - start);
+          double start = XferStatsStart(stats);
+          amtXferred = XferExtents(access, fd, buffer, transfer, offset, ioBuffers, test);
+          XferStatsRecord(stats, start, GetTimeStamp(), offset, amtXferred);
           if (amtXferred != transfer)
                   ERR("cannot read from file write check");
-          *errors += CompareData(buffer, transfer, test, offset, pretendRank, WRITECHECK);
+          if (ioBuffers->verifyPool)
+                  VerifyPoolSubmit(ioBuffers->verifyPool, buffer, offset, transfer, pretendRank, WRITECHECK);
+          else
+                  *errors += CompareExtents(buffer, transfer, test, offset, pretendRank, WRITECHECK);
   } else if (access == READCHECK) {
+          if (ioBuffers->verifyPool)
+                  buffer = VerifyPoolBuffer(ioBuffers->verifyPool);
           invalidate_buffer_pattern(buffer, transfer, test->gpuMemoryFlags);          
-          double start = GetTimeStamp();
-          amtXferred = backend->xfer(access, fd, buffer, transfer, offset, test->backend_options);
-          if(ot) OpTimerValue(ot, start - startTime, GetTimeStamp() - start);
+          double start = XferStatsStart(stats);
+          amtXferred = XferExtents(access, fd, buffer, transfer, offset, ioBuffers, test);
+          XferStatsRecord(stats, start, GetTimeStamp(), offset, amtXferred);
           if (amtXferred != transfer){
             ERR("cannot read from file");
           }
-          *errors += CompareData(buffer, transfer, test, offset, pretendRank, READCHECK);
+          if (ioBuffers->verifyPool)
+                  VerifyPoolSubmit(ioBuffers->verifyPool, buffer, offset, transfer, pretendRank, READCHECK);
+          else
+                  *errors += CompareExtents(buffer, transfer, test, offset, pretendRank, READCHECK);
+  }
+  return amtXferred;
+}
+
+/*
+ * Transfers in flight if queueDepth > 1, every slot owns one of the buffers
+ * in IOR_io_buffers.queueBuffers and is used as tag for xfer_submit().
+ */
+typedef struct {
+  void * buffer;
+  IOR_offset_t offset;
+  IOR_offset_t size;
+  double start;                    /* submission time for the latency */
+} xfer_slot_t;
+
+typedef struct {
+  int depth;
+  int pending;                     /* number of transfers in flight */
+  int free_count;
+  xfer_slot_t * slots;
+  xfer_slot_t ** free_slots;       /* stack of unused slots */
+  aiori_xfer_completion_t * completions;
+} xfer_queue_t;
+
+static xfer_queue_t * XferQueueInit(int depth, IOR_io_buffers* ioBuffers){
+  xfer_queue_t * q = safeMalloc(sizeof(xfer_queue_t));
+  q->depth = depth;
+  q->pending = 0;
+  q->free_count = depth;
+  q->slots = safeMalloc(sizeof(xfer_slot_t) * depth);
+  q->free_slots = safeMalloc(sizeof(xfer_slot_t*) * depth);
+  q->completions = safeMalloc(sizeof(aiori_xfer_completion_t) * depth);
+  for (int i = 0; i < depth; i++){
+    q->slots[i].buffer = ioBuffers->queueBuffers[i];
+    q->free_slots[i] = & q->slots[depth - 1 - i];
+  }
+  return q;
+}
+
+static void XferQueueFree(xfer_queue_t * q){
+  free(q->slots);
+  free(q->free_slots);
+  free(q->completions);
+  free(q);
+}
+
+/*
+ * Account for completed transfers and verify the data of checks, returns the amount of data moved.
+ */
+static IOR_offset_t XferQueueComplete(xfer_queue_t * q, int count, int pretendRank, int * errors, IOR_param_t * test, int access, xfer_stats_t * stats){
+  IOR_offset_t amtXferred = 0;
+  double now = GetTimeStamp();
+  for (int i = 0; i < count; i++){
+    xfer_slot_t * s = (xfer_slot_t*) q->completions[i].tag;
+    if (q->completions[i].amount != s->size){
+      if (access == WRITE)
+        ERR("cannot write to file");
+      ERR("cannot read from file");
+    }
+    XferStatsRecord(stats, s->start, now, s->offset, s->size);
+    if (access == WRITECHECK || access == READCHECK){
+      *errors += CompareData(s->buffer, s->size, test, s->offset, pretendRank, access);
+    }
+    amtXferred += s->size;
+    q->free_slots[q->free_count++] = s;
+  }
+  q->pending -= count;
+  return amtXferred;
+}
+
+/*
+ * Submit a single transfer into a free slot, if all slots are in flight wait for completions first.
+ * Returns the amount of data moved by completed transfers.
+ */
+static IOR_offset_t WriteOrReadQueued(xfer_queue_t * q, IOR_offset_t offset, int pretendRank, IOR_offset_t transfer, int * errors, IOR_param_t * test, aiori_fd_t * fd, int access, xfer_stats_t * stats){
+  IOR_offset_t amtXferred = 0;
+  while (q->free_count == 0){
+    int count = 0;
+    if (backend->xfer_poll){
+      count = backend->xfer_poll(fd, q->completions, q->depth, test->backend_options);
+    }
+    if (count == 0){
+      count = backend->xfer_wait(fd, q->completions, 1, q->depth, test->backend_options);
+    }
+    amtXferred += XferQueueComplete(q, count, pretendRank, errors, test, access, stats);
+  }
+  xfer_slot_t * s = q->free_slots[--q->free_count];
+  s->offset = offset;
+  s->size = transfer;
+  if (access == WRITE) {
+    update_write_memory_pattern(offset, s->buffer, transfer, test->timeStampSignatureValue, pretendRank, test->dataPacketType, test->gpuMemoryFlags);
+  } else if (access == WRITECHECK || access == READCHECK) {
+    invalidate_buffer_pattern(s->buffer, transfer, test->gpuMemoryFlags);
+  }
+  s->start = XferStatsStart(stats);
+  if (backend->xfer_submit(access, fd, s->buffer, transfer, offset, s, test->backend_options) != 0){
+    ERR("cannot submit transfer");
+  }
+  q->pending++;
+  if (test->interIODelay > 0){
+    struct timespec wait = {test->interIODelay / 1000 / 1000, 1000l * (test->interIODelay % 1000000)};
+    nanosleep( & wait, NULL);
   }
   return amtXferred;
 }
 
+/*
+ * Wait until all transfers in flight completed, returns the amount of data moved.
+ */
+static IOR_offset_t XferQueueDrain(xfer_queue_t * q, int pretendRank, int * errors, IOR_param_t * test, aiori_fd_t * fd, int access, xfer_stats_t * stats){
+  IOR_offset_t amtXferred = 0;
+  while (q->pending > 0){
+    int count = backend->xfer_wait(fd, q->completions, q->pending, q->depth, test->backend_options);
+    amtXferred += XferQueueComplete(q, count, pretendRank, errors, test, access, stats);
+  }
+  return amtXferred;
+}
+
+/*
+ * With collective I/O all processes must issue the same number of transfers,
+ * thus they agree on the transfer at which a stonewalled phase ends.  Every
+ * interval transfers a non-blocking reduction of the local deadlines is
+ * started and polled after each transfer, its result is needed by the time
+ * the next reduction starts.  If the deadline of any process has passed, all
+ * processes stop there.  The starts are counted in transfers as all
+ * processes must start the reductions in the same order.
+ */
+typedef struct {
+  int interval;
+  MPI_Request request;
+  int local;                       /* the deadline of this process has passed */
+  int global;                      /* the deadline of any process has passed */
+} stonewall_agreement_t;
+
+static void StonewallAgreementInit(stonewall_agreement_t * a, int interval){
+  a->interval = interval;
+  a->request = MPI_REQUEST_NULL;
+  a->local = 0;
+  a->global = 0;
+}
+
+/*
+ * Returns 1 if the processes agreed to stop after pairCnt transfers.
+ */
+static int StonewallAgreementCheck(stonewall_agreement_t * a, uint64_t pairCnt, int deadline){
+  if (a->request != MPI_REQUEST_NULL){
+    int done;
+    MPI_CHECK(MPI_Test(& a->request, & done, MPI_STATUS_IGNORE), "cannot test stonewall agreement");
+  }
+  if (pairCnt % a->interval != 0)
+    return 0;
+  MPI_CHECK(MPI_Wait(& a->request, MPI_STATUS_IGNORE), "cannot wait for stonewall agreement");
+  if (a->global)
+    return 1;
+  a->local = deadline;
+  MPI_CHECK(MPI_Iallreduce(& a->local, & a->global, 1, MPI_INT, MPI_MAX, testComm, & a->request), "cannot start stonewall agreement");
+  return 0;
+}
+
+static void StonewallAgreementFinish(stonewall_agreement_t * a){
+  MPI_CHECK(MPI_Wait(& a->request, MPI_STATUS_IGNORE), "cannot wait for stonewall agreement");
+}
+
+/*
+ * A thread performing I/O if threadsPerRank > 1, it accesses the transfers
+ * [first, last) of every segment using its own buffer.
+ */
+typedef struct {
+  IOR_param_t * test;
+  aiori_fd_t * fd;
+  int access;
+  int pretendRank;
+  random_offsets_t * perm;
+  IOR_offset_t first;
+  IOR_offset_t last;
+  IOR_io_buffers buffers;
+  double startTime;
+  int * hitStonewall;              /* shared by the threads of a process, accessed atomically */
+  pthread_t thread;
+  /* results */
+  xfer_schedule_t schedule;
+  xfer_stats_t stats;
+  IOR_offset_t dataMoved;
+  uint64_t pairCnt;
+  int errors;
+  double runtime;
+} xfer_thread_t;
+
+static void * WriteOrReadThread(void * arg){
+  xfer_thread_t * t = (xfer_thread_t*) arg;
+  IOR_param_t * test = t->test;
+
+  do{
+    for (IOR_offset_t i = 0; i < test->segmentCount && ! __atomic_load_n(t->hitStonewall, __ATOMIC_RELAXED); i++) {
+      for (IOR_offset_t j = t->first; j < t->last && ! __atomic_load_n(t->hitStonewall, __ATOMIC_RELAXED); j++) {
+        IOR_offset_t transfer;
+        IOR_offset_t offset = GetOffset(test, t->perm, t->pretendRank, i, j, & transfer);
+        t->dataMoved += WriteOrReadSingle(offset, t->pretendRank, transfer, & t->errors, test, t->fd, & t->buffers, t->access, & t->stats);
+        t->pairCnt++;
+        if (test->deadlineForStonewalling != 0
+            && (GetTimeStamp() - t->startTime) > test->deadlineForStonewalling) {
+          /* the other threads stop after their current transfer */
+          __atomic_store_n(t->hitStonewall, 1, __ATOMIC_RELAXED);
+        }
+      }
+    }
+  } while(! __atomic_load_n(t->hitStonewall, __ATOMIC_RELAXED) && (GetTimeStamp() - t->startTime) < test->minTimeDuration);
+  t->runtime = GetTimeStamp() - t->startTime;
+  return NULL;
+}
+
+/*
+ * Perform the I/O of the process with threadsPerRank threads, each accessing
+ * a disjoint slice of the transfers of every block.
+ * Returns the amount of data moved, errors and pairs are accumulated.
+ */
+static IOR_offset_t WriteOrReadThreaded(IOR_param_t * test, aiori_fd_t * fd, int access, IOR_io_buffers * ioBuffers, random_offsets_t * perm, int pretendRank, int * errors, uint64_t * pairCnt, xfer_stats_t * stats, IOR_point_t * point){
+  int count = test->threadsPerRank;
+  IOR_offset_t offsets = test->transfersPerBlock;
+  IOR_offset_t dataMoved = 0;
+  int hitStonewall = 0;
+  double runtime_min, runtime_max;
+  xfer_thread_t * threads = safeMalloc(sizeof(xfer_thread_t) * count);
+
+  for (int t = 0; t < count; t++) {
+    xfer_thread_t * x = & threads[t];
+    memset(x, 0, sizeof(xfer_thread_t));
+    x->test = test;
+    x->fd = fd;
+    x->access = access;
+    x->pretendRank = pretendRank;
+    x->perm = perm;
+    x->first = offsets * t / count;
+    x->last = offsets * (t + 1) / count;
+    x->buffers.buffer = ioBuffers->threadBuffers[t];
+    x->buffers.extents = XferExtentsAlloc(test);
+    x->startTime = stats->startTime;
+    x->hitStonewall = & hitStonewall;
+    x->stats.startTime = stats->startTime;
+    if (stats->latency)
+      x->stats.latency = LatencyHistogramInit();
+    if (stats->samples)
+      x->stats.samples = IntervalSamplesInit(stats->samplesOrigin, test->sampleInterval);
+    if (stats->unique)
+      x->stats.unique = UniqueCounterInit();
+    x->stats.uniqueKey = stats->uniqueKey;
+    if (stats->schedule) {
+      XferScheduleInit(& x->schedule, test, stats->startTime, test->numTasks * count, pretendRank * count + t);
+      x->stats.schedule = & x->schedule;
+    }
+    int ret = pthread_create(& x->thread, NULL, WriteOrReadThread, x);
+    if (ret != 0)
+      ERRF("pthread_create() failed: %s", strerror(ret));
+  }
+  runtime_min = 1e308;
+  runtime_max = 0;
+  for (int t = 0; t < count; t++) {
+    xfer_thread_t * x = & threads[t];
+    int ret = pthread_join(x->thread, NULL);
+    if (ret != 0)
+      ERRF("pthread_join() failed: %s", strerror(ret));
+    dataMoved += x->dataMoved;
+    *pairCnt += x->pairCnt;
+    *errors += x->errors;
+    if (stats->latency) {
+      LatencyHistogramMerge(stats->latency, x->stats.latency);
+      LatencyHistogramFree(& x->stats.latency);
+    }
+    if (stats->samples) {
+      IntervalSamplesMerge(stats->samples, x->stats.samples);
+      IntervalSamplesFree(& x->stats.samples);
+    }
+    if (stats->unique) {
+      UniqueCounterMerge(stats->unique, x->stats.unique);
+      UniqueCounterFree(& x->stats.unique);
+    }
+    free(x->buffers.extents);
+    if (x->runtime < runtime_min)
+      runtime_min = x->runtime;
+    if (x->runtime > runtime_max)
+      runtime_max = x->runtime;
+  }
+  free(threads);
+
+  MPI_CHECK(MPI_Reduce(& runtime_min, & point->thread_time_min, 1, MPI_DOUBLE, MPI_MIN, 0, testComm), "cannot reduce thread runtime");
+  MPI_CHECK(MPI_Reduce(& runtime_max, & point->thread_time_max, 1, MPI_DOUBLE, MPI_MAX, 0, testComm), "cannot reduce thread runtime");
+  if (rank == 0 && verbose >= VERBOSE_1) {
+    fprintf(out_logfile, "%d threads per process, runtime of the fastest thread: %.3fs slowest thread: %.3fs\n",
+            count, point->thread_time_min, point->thread_time_max);
+  }
+  return dataMoved;
+}
+
+/*
+ * State of a phase of mixed writes and reads if rwmix > 0, the writes are
+ * accounted in the statistics of the phase.
+ */
+typedef struct {
+  double readFraction;
+  unsigned short seed[3];
+  unsigned char * written;         /* bitmap of the transfers with known content */
+  IOR_io_buffers buffers;          /* buffer for the reads */
+  xfer_stats_t stats;              /* accounting of the reads */
+  IOR_offset_t dataRead;
+  uint64_t readCnt;
+} xfer_mix_t;
+
+/*
+ * Perform a write or, with the probability of rwmix percent, a read of
+ * transfer xfer of the process.  Reads of transfers written before are
+ * verified if checkRead is set.  Returns the amount of data moved.
+ */
+static IOR_offset_t WriteOrReadMixed(xfer_mix_t * mix, IOR_offset_t xfer, IOR_offset_t offset, IOR_offset_t transfer, int pretendRank, int * errors, IOR_param_t * test, aiori_fd_t * fd, IOR_io_buffers * ioBuffers, xfer_stats_t * stats){
+  if (erand48(mix->seed) < mix->readFraction){
+    int verify = test->checkRead && (mix->written[xfer / 8] & (1 << (xfer % 8)));
+    IOR_offset_t amtXferred = WriteOrReadSingle(offset, pretendRank, transfer, errors, test, fd, & mix->buffers, verify ? READCHECK : READ, & mix->stats);
+    mix->dataRead += amtXferred;
+    mix->readCnt++;
+    return amtXferred;
+  }
+  mix->written[xfer / 8] |= 1 << (xfer % 8);
+  return WriteOrReadSingle(offset, pretendRank, transfer, errors, test, fd, ioBuffers, WRITE, stats);
+}
+
 static void prefillSegment(IOR_param_t *test, void * randomPrefillBuffer, int pretendRank, aiori_fd_t *fd, IOR_io_buffers *ioBuffers, int startSegment, int endSegment){
   // prefill the whole file already with an invalid pattern
   int offsets = test->blockSize / test->randomPrefillBlocksize;
@@ -1706,12 +2810,8 @@ static void prefillSegment(IOR_param_t *test, void * randomPrefillBuffer, int pr
   for (IOR_offset_t i = startSegment; i < endSegment; i++){
     for (int j = 0; j < offsets; j++) {
       IOR_offset_t offset = j * test->randomPrefillBlocksize;
-      if (test->filePerProc) {
-        offset += i * test->blockSize;
-      } else {
-        offset += (i * test->numTasks * test->blockSize) + (pretendRank * test->blockSize);
-      }
-      WriteOrReadSingle(offset, pretendRank, test->randomPrefillBlocksize, & errors, test, fd, ioBuffers, WRITE, NULL, 0);
+      offset += (i * RanksPerFile(test) + pretendRank % RanksPerFile(test)) * test->blockSize;
+      WriteOrReadSingle(offset, pretendRank, test->randomPrefillBlocksize, & errors, test, fd, ioBuffers, WRITE, NULL);
     }
   }
   ioBuffers->buffer = oldBuffer;
@@ -1730,21 +2830,16 @@ static IOR_offset_t WriteOrRead(IOR_param_t *test, int rep, IOR_results_t *resul
         IOR_offset_t dataMoved = 0;     /* for data rate calculation */
         double startForStonewall;
         int hitStonewall;
-        IOR_offset_t i, j;
-        IOR_point_t *point = ((access == WRITE) || (access == WRITECHECK)) ?
-                             &results->write : &results->read;
+        IOR_offset_t i = 0, j = 0;
+        IOR_point_t *point = GetResultPoint(results, access);
 
         /* initialize values */
         pretendRank = (rank + rankOffset) % test->numTasks;
 
-        //  offsetArray = GetOffsetArraySequential(test, pretendRank);
-
-        IOR_offset_t offsets;
-        IOR_offset_t * offsets_rnd;
+        IOR_offset_t offsets = test->transfersPerBlock;
+        random_offsets_t perm;
         if (test->randomOffset) {
-          offsets_rnd = GetOffsetArrayRandom(test, pretendRank, & offsets);
-        }else{
-          offsets = (test->blockSize / test->transferSize);
+          RandomOffsetInit(test, pretendRank, & perm);
         }
 
         void * randomPrefillBuffer = NULL;
@@ -1754,16 +2849,38 @@ static IOR_offset_t WriteOrRead(IOR_param_t *test, int rep, IOR_results_t *resul
           memset(randomPrefillBuffer, -1, test->randomPrefillBlocksize);
         }
 
+        xfer_queue_t * queue = NULL;
+        if (test->queueDepth > 1) {
+          queue = XferQueueInit(test->queueDepth, ioBuffers);
+        }
+        if (test->verifyThreads > 0 && (access == WRITECHECK || access == READCHECK)) {
+          ioBuffers->verifyPool = VerifyPoolInit(test);
+        }
+
         /* Per operation statistics */
-        OpTimer * ot = NULL;
+        xfer_stats_t stats = {0};
+        xfer_schedule_t schedule;
         if(test->savePerOpDataCSV != NULL) {
                 char fname[FILENAME_MAX];
                 sprintf(fname, "%s-%d-%05d.csv", test->savePerOpDataCSV, rep, rank);
-                ot = OpTimerInit(fname, test->transferSize);
+                stats.ot = OpTimerInit(fname, test->transferSize);
+        }
+        /* Latency histogram and distinct data of the timed phases */
+        if (access != WRITECHECK) {
+                stats.latency = LatencyHistogramInit();
+                stats.unique = UniqueCounterInit();
+                /* distinguish the files */
+                stats.uniqueKey = (uint64_t) (pretendRank / RanksPerFile(test)) * 0x9e3779b97f4a7c15ULL;
         }
         // start timer after random offset was generated        
         startForStonewall = GetTimeStamp();
         hitStonewall = 0;
+        stats.startTime = startForStonewall;
+        if (test->sampleInterval > 0 && access != WRITECHECK) {
+                /* all processes use the same intervals */
+                MPI_CHECK(MPI_Allreduce(& startForStonewall, & stats.samplesOrigin, 1, MPI_DOUBLE, MPI_MIN, testComm), "cannot reduce start time");
+                stats.samples = IntervalSamplesInit(stats.samplesOrigin, test->sampleInterval);
+        }
 
         if(randomPrefillBuffer && test->deadlineForStonewalling == 0){
           double t_start = GetTimeStamp();
@@ -1774,49 +2891,88 @@ static IOR_offset_t WriteOrRead(IOR_param_t *test, int rep, IOR_results_t *resul
           // must synchronize processes to ensure they are not running ahead
           MPI_Barrier(test->testComm);
         }
+        if (test->targetIOPS > 0 || test->targetBandwidth > 0) {
+                /* the schedule starts after the prefill, the checks follow it as well */
+                XferScheduleInit(& schedule, test, GetTimeStamp(), test->numTasks, pretendRank);
+                stats.schedule = & schedule;
+        }
+        /* Mixed writes and reads, the reads have their own statistics */
+        xfer_mix_t mix = {0};
+        if (access == RWMIX) {
+                size_t bitmapSize = (test->segmentCount * offsets + 7) / 8;
+                mix.readFraction = test->rwmix / 100.0;
+                mix.seed[0] = 0x330e;
+                mix.seed[1] = pretendRank;
+                mix.seed[2] = rep;
+                /* the content is known if the write phase of this repetition wrote all transfers */
+                mix.written = safeMalloc(bitmapSize);
+                memset(mix.written, test->writeFile && test->deadlineForStonewalling == 0 ? 0xff : 0, bitmapSize);
+                mix.buffers.buffer = ioBuffers->mixReadBuffer;
+                mix.buffers.extents = ioBuffers->extents;
+                mix.stats = stats;
+                mix.stats.latency = LatencyHistogramInit();
+                mix.stats.unique = UniqueCounterInit();
+                if (stats.samples)
+                        mix.stats.samples = IntervalSamplesInit(stats.samplesOrigin, test->sampleInterval);
+        }
 
-        do{ // to ensure the benchmark runs a certain time
-          for (i = 0; i < test->segmentCount && !hitStonewall; i++) {
-            if(randomPrefillBuffer && test->deadlineForStonewalling != 0){
-              // prefill the whole segment with data, this needs to be done collectively
-              double t_start = GetTimeStamp();
-              prefillSegment(test, randomPrefillBuffer, pretendRank, fd, ioBuffers, i, i+1);
-              MPI_Barrier(test->testComm);
-              if(rank == 0 && verbose > VERBOSE_1){
-                fprintf(out_logfile, "Random: synchronizing segment count with barrier and prefill took: %fs\n", GetTimeStamp() - t_start);
-              }
-            }
-            for (j = 0; j < offsets &&  !hitStonewall ; j++) {
-              IOR_offset_t offset;
-              if (test->randomOffset) {
-                if(test->filePerProc){
-                  offset = offsets_rnd[j] + (i * test->blockSize);
-                }else{
-                  offset = offsets_rnd[j] + (i * test->numTasks * test->blockSize);
+        stonewall_agreement_t agreementState;
+        stonewall_agreement_t * agreement = NULL;
+        if (test->collective && test->deadlineForStonewalling) {
+          StonewallAgreementInit(& agreementState, test->stoneWallingAgreementInterval);
+          agreement = & agreementState;
+        }
+
+        if (test->threadsPerRank > 1) {
+          dataMoved = WriteOrReadThreaded(test, fd, access, ioBuffers, & perm, pretendRank, & errors, & pairCnt, & stats, point);
+        } else {
+          do{ // to ensure the benchmark runs a certain time
+            for (i = 0; i < test->segmentCount && !hitStonewall; i++) {
+              if(randomPrefillBuffer && test->deadlineForStonewalling != 0){
+                // prefill the whole segment with data, this needs to be done collectively
+                if (queue) {
+                  // the synchronous prefill must not overlap with tagged transfers
+                  dataMoved += XferQueueDrain(queue, pretendRank, & errors, test, fd, access, & stats);
                 }
-              }else{
-                offset = j * test->transferSize;
-                if (test->filePerProc) {
-                  offset += i * test->blockSize;
-                } else {
-                  offset += (i * test->numTasks * test->blockSize) + (pretendRank * test->blockSize);
+                double t_start = GetTimeStamp();
+                prefillSegment(test, randomPrefillBuffer, pretendRank, fd, ioBuffers, i, i+1);
+                MPI_Barrier(test->testComm);
+                if(rank == 0 && verbose > VERBOSE_1){
+                  fprintf(out_logfile, "Random: synchronizing segment count with barrier and prefill took: %fs\n", GetTimeStamp() - t_start);
                 }
               }
-              dataMoved += WriteOrReadSingle(offset, pretendRank, test->transferSize, & errors, test, fd, ioBuffers, access, ot, startForStonewall);
-              pairCnt++;
-
-              hitStonewall = ((test->deadlineForStonewalling != 0
-                  && (GetTimeStamp() - startForStonewall) > test->deadlineForStonewalling))
-                  || (test->stoneWallingWearOutIterations != 0 && pairCnt == test->stoneWallingWearOutIterations) ;
+              for (j = 0; j < offsets &&  !hitStonewall ; j++) {
+                IOR_offset_t transfer;
+                IOR_offset_t offset = GetOffset(test, & perm, pretendRank, i, j, & transfer);
+                if (queue) {
+                  dataMoved += WriteOrReadQueued(queue, offset, pretendRank, transfer, & errors, test, fd, access, & stats);
+                } else if (access == RWMIX) {
+                  dataMoved += WriteOrReadMixed(& mix, i * offsets + j, offset, transfer, pretendRank, & errors, test, fd, ioBuffers, & stats);
+                } else {
+                  dataMoved += WriteOrReadSingle(offset, pretendRank, transfer, & errors, test, fd, ioBuffers, access, & stats);
+                }
+                pairCnt++;
 
-              if ( test->collective && test->deadlineForStonewalling ) {
-                // if collective-mode, you'll get a HANG, if some rank 'accidentally' leave this loop
-                // it absolutely must be an 'all or none':
-                MPI_CHECK(MPI_Bcast(&hitStonewall, 1, MPI_INT, 0, testComm), "hitStonewall broadcast failed");
+                int deadline = test->deadlineForStonewalling != 0
+                    && (GetTimeStamp() - startForStonewall) > test->deadlineForStonewalling;
+                hitStonewall = test->stoneWallingWearOutIterations != 0 && pairCnt == test->stoneWallingWearOutIterations;
+                if (agreement) {
+                  // if collective-mode, you'll get a HANG, if some rank 'accidentally' leave this loop
+                  // it absolutely must be an 'all or none':
+                  hitStonewall |= StonewallAgreementCheck(agreement, pairCnt, deadline);
+                } else {
+                  hitStonewall |= deadline;
+                }
               }
             }
+          } while((GetTimeStamp() - startForStonewall) < test->minTimeDuration);
+          if (agreement) {
+            StonewallAgreementFinish(agreement);
           }
-        } while((GetTimeStamp() - startForStonewall) < test->minTimeDuration);
+        }
+        if (queue) {
+          dataMoved += XferQueueDrain(queue, pretendRank, & errors, test, fd, access, & stats);
+        }
         if (test->stoneWallingWearOut){
           if (verbose >= VERBOSE_1){
             fprintf(out_logfile, "%d: stonewalling pairs accessed: %lld\n", rank, (long long) pairCnt);
@@ -1850,35 +3006,78 @@ static IOR_offset_t WriteOrRead(IOR_param_t *test, int rep, IOR_results_t *resul
             for ( ; pairCnt < point->pairs_accessed; i++) {
               if(i == test->segmentCount) i = 0; // wrap over, necessary to deal with minTimeDuration
               for ( ; j < offsets && pairCnt < point->pairs_accessed ; j++) {
-                IOR_offset_t offset;
-                if (test->randomOffset) {
-                  if(test->filePerProc){
-                    offset = offsets_rnd[j] + (i * test->blockSize);
-                  }else{
-                    offset = offsets_rnd[j] + (i * test->numTasks * test->blockSize);
-                  }
-                }else{
-                  offset = j * test->transferSize;
-                  if (test->filePerProc) {
-                    offset += i * test->blockSize;
-                  } else {
-                    offset += (i * test->numTasks * test->blockSize) + (pretendRank * test->blockSize);
-                  }
+                IOR_offset_t transfer;
+                IOR_offset_t offset = GetOffset(test, & perm, pretendRank, i, j, & transfer);
+                if (queue) {
+                  dataMoved += WriteOrReadQueued(queue, offset, pretendRank, transfer, & errors, test, fd, access, & stats);
+                } else {
+                  dataMoved += WriteOrReadSingle(offset, pretendRank, transfer, & errors, test, fd, ioBuffers, access, & stats);
                 }
-                dataMoved += WriteOrReadSingle(offset, pretendRank, test->transferSize, & errors, test, fd, ioBuffers, access, ot, startForStonewall);
                 pairCnt++;
               }
               j = 0;              
             }
+            if (queue) {
+              dataMoved += XferQueueDrain(queue, pretendRank, & errors, test, fd, access, & stats);
+            }
           }
         }else{
           point->pairs_accessed = pairCnt;
         }
+        if (queue) {
+          XferQueueFree(queue);
+        }
+        if (ioBuffers->verifyPool) {
+          errors += VerifyPoolFinish(ioBuffers->verifyPool);
+          ioBuffers->verifyPool = NULL;
+        }
 
-        OpTimerFree(& ot);
+        OpTimerFree(& stats.ot);
+        if (stats.latency) {
+                LatencyHistogramFree(& point->latencyHistogram);
+                point->latencyHistogram = LatencyHistogramReduce(stats.latency, 0, testComm);
+                LatencyHistogramFree(& stats.latency);
+        }
+        if (stats.samples) {
+                IntervalSamplesFree(& point->intervalSamples);
+                point->intervalSamples = IntervalSamplesReduce(stats.samples, 0, testComm);
+                IntervalSamplesFree(& stats.samples);
+        }
+        if (stats.unique) {
+                UniqueCounter * unique = UniqueCounterReduce(stats.unique, 0, testComm);
+                if (unique)
+                        point->unique_bytes = UniqueCounterEstimate(unique) * test->blockSize / test->transfersPerBlock;
+                UniqueCounterFree(& unique);
+                UniqueCounterFree(& stats.unique);
+        }
+        if (access == RWMIX) {
+                IOR_point_t *readPoint = GetResultPoint(results, RWMIX_READ);
+                IOR_offset_t moved[2] = {dataMoved - mix.dataRead, mix.dataRead};
+                IOR_offset_t aggMoved[2];
+                MPI_CHECK(MPI_Allreduce(moved, aggMoved, 2, MPI_LONG_LONG_INT, MPI_SUM, testComm), "cannot total data moved");
+                point->aggFileSizeFromXfer = point->aggFileSizeForBW = aggMoved[0];
+                readPoint->aggFileSizeFromXfer = readPoint->aggFileSizeForBW = aggMoved[1];
+                point->pairs_accessed = pairCnt - mix.readCnt;
+                readPoint->pairs_accessed = mix.readCnt;
+
+                LatencyHistogramFree(& readPoint->latencyHistogram);
+                readPoint->latencyHistogram = LatencyHistogramReduce(mix.stats.latency, 0, testComm);
+                LatencyHistogramFree(& mix.stats.latency);
+                if (mix.stats.samples) {
+                        IntervalSamplesFree(& readPoint->intervalSamples);
+                        readPoint->intervalSamples = IntervalSamplesReduce(mix.stats.samples, 0, testComm);
+                        IntervalSamplesFree(& mix.stats.samples);
+                }
+                UniqueCounter * unique = UniqueCounterReduce(mix.stats.unique, 0, testComm);
+                if (unique)
+                        readPoint->unique_bytes = UniqueCounterEstimate(unique) * test->blockSize / test->transfersPerBlock;
+                UniqueCounterFree(& unique);
+                UniqueCounterFree(& mix.stats.unique);
+                free(mix.written);
+        }
         totalErrorCount += CountErrors(test, access, errors);
 
-        if (access == WRITE && test->fsync == TRUE) {
+        if ((access == WRITE || access == RWMIX) && test->fsync == TRUE) {
                 backend->fsync(fd, test->backend_options);       /*fsync after all accesses */
         }
         if(randomPrefillBuffer){
@@ -51,6 +51,11 @@ typedef struct IO_BUFFERS
     void* buffer;
     void* checkBuffer;
     void* readCheckBuffer;
+    void** queueBuffers;   /* one buffer per slot if queueDepth > 1 */
+    void** threadBuffers;  /* one buffer per thread if threadsPerRank > 1 */
+    void* mixReadBuffer;   /* buffer of the reads if rwmix > 0, keeping the write pattern intact */
+    aiori_xfer_extent_t * extents; /* extents of a transfer if extentSize > 0 */
+    struct verify_pool * verifyPool; /* checks are verified by threads if verifyThreads > 0 */
 
 } IOR_io_buffers;
 
@@ -96,10 +101,23 @@ typedef struct
     int multiFile;                   /* multiple files */
     int interTestDelay;              /* delay between reps in seconds */
     int interIODelay;                /* delay after each I/O in us */
+    int queueDepth;                  /* number of transfers kept in flight using xfer_submit() */
+    int verifyThreads;               /* threads verifying the checked transfers while the next are read */
+    int threadsPerRank;              /* number of threads performing I/O in each process */
+    double sampleInterval;           /* length of the intervals of the throughput time series in s */
+    double targetIOPS;               /* open loop transfer rate of all processes */
+    IOR_offset_t targetBandwidth;    /* open loop bandwidth of all processes in bytes/s */
+    int targetPoisson;               /* Poisson instead of constant arrivals for the target rate */
+    char * offsetDistribution;       /* skewed distribution of the random offsets, NULL for a permutation */
+    int rwmix;                       /* percentage of reads in a phase of mixed writes and reads, 0 disables it */
     int open;                        /* flag for writing or reading */
     int readFile;                    /* read of existing file */
     int writeFile;                   /* write of file */
     int filePerProc;                 /* single file or file-per-process */
+    int ranksPerFile;                /* groups of processes sharing a file if > 1 */
+    char * cacheControl;             /* cache operations before reading back, e.g., fadvise+syncfs */
+    int cacheControlOps;             /* IOR_CACHE_* operations of cacheControl */
+    int cacheResidency;              /* report the cached fraction of the files before reading back */
     int reorderTasks;                /* reorder tasks for read back and check */
     int taskPerNodeOffset;           /* task node offset for reading files   */
     int reorderTasksRandom;          /* reorder tasks for random file read back */
@@ -111,7 +129,15 @@ typedef struct
     int errorFound;                  /* error found in data check */
     IOR_offset_t segmentCount;       /* number of segments (or HDF5 datasets) */
     IOR_offset_t blockSize;          /* contiguous bytes to write per task */
-    IOR_offset_t transferSize;       /* size of transfer in bytes */
+    IOR_offset_t transferSize;       /* size of transfer in bytes, the largest size with transferSizes */
+    char * transferSizes;            /* distribution of the sizes of the transfers, NULL for transferSize */
+    IOR_offset_t transfersPerBlock;  /* number of transfers of a block */
+    IOR_offset_t * transferOffsets;  /* offsets of the transfers in a block with transferSizes */
+    IOR_offset_t extentSize;         /* access every transfer as extents of this size with one vectored call, 0 disables it */
+    IOR_offset_t fileHole;           /* bytes skipped in the file after every extent */
+    IOR_offset_t memoryHole;         /* bytes skipped in the buffer after every extent */
+    char * layout;                   /* block-cyclic decomposition of an N-d array in a shared file, NULL to disable */
+    struct array_layout * arrayLayout; /* the parsed layout during a test */
     IOR_offset_t expectedAggFileSize; /* calculated aggregate file size */
     IOR_offset_t randomPrefillBlocksize;   /* prefill option for random IO, the amount of data used for prefill */
 
@@ -124,6 +150,7 @@ typedef struct
     int stoneWallingWearOut;         /* wear out the stonewalling, once the timeout is over, each process has to write the same amount */
     int minTimeDuration;             /* minimum runtime */
     uint64_t stoneWallingWearOutIterations; /* the number of iterations for the stonewallingWearOut, needed for readBack */
+    int stoneWallingAgreementInterval; /* with collective I/O, transfers between the agreements on the stonewall */
     char * stoneWallingStatusFile;
 
     int maxTimeDuration;             /* max time in minutes to run each test */
@@ -140,6 +167,8 @@ typedef struct
     char * testscripts;              /* for parsing */
     char * buffer_type;              /* for parsing */
     ior_dataPacketType_e dataPacketType; /* The type of data packet.  */
+    double dedupeCompress;           /* compression ratio of each block for DATA_DEDUPE */
+    double dedupeFraction;           /* fraction of duplicated blocks for DATA_DEDUPE */
 
     void * backend_options;          /* Backend-specific options */
 
@@ -167,6 +196,13 @@ typedef struct {
    long long  stonewall_avg_data_accessed; // across all processes
    long long  stonewall_total_data_accessed; // sum accross all processes
 
+   double     thread_time_min; // runtime of the fastest thread of all processes, if threadsPerRank > 1
+   double     thread_time_max; // runtime of the slowest thread of all processes
+
+   struct LatencyHistogram * latencyHistogram; // transfer latency of all processes, only on rank 0
+   struct IntervalSamples * intervalSamples; // throughput over time of all processes, only on rank 0
+   double     unique_bytes; // estimated distinct bytes accessed by all processes, only on rank 0
+
    IOR_offset_t aggFileSizeFromStat;
    IOR_offset_t aggFileSizeFromXfer;
    IOR_offset_t aggFileSizeForBW;
@@ -176,6 +212,8 @@ typedef struct {
    int          errors;
    IOR_point_t  write;
    IOR_point_t  read;
+   IOR_point_t  mixwrite;             /* writes of the rwmix phase */
+   IOR_point_t  mixread;              /* reads of the rwmix phase */
 } IOR_results_t;
 
 /* define the queuing structure for the test parameters */
@@ -23,7 +23,8 @@ typedef enum {
   DATA_TIMESTAMP, /* Will not include any offset, hence each buffer will be the same */
   DATA_OFFSET,
   DATA_INCOMPRESSIBLE,  /* Will include the offset as well */
-  DATA_RANDOM           /* fully scrambled blocks */
+  DATA_RANDOM,          /* fully scrambled blocks */
+  DATA_DEDUPE           /* 4 KiB blocks with a target compression ratio and fraction of duplicates */
 } ior_dataPacketType_e;
 
 typedef enum{
@@ -101,6 +102,9 @@ enum OutputFormat_t{
 #define WRITECHECK         1
 #define READ               2
 #define READCHECK          3
+#define RWMIX              4            /* writes and reads mixed in one phase */
+#define RWMIX_WRITE        5            /* the writes of a RWMIX phase, for results */
+#define RWMIX_READ         6            /* the reads of a RWMIX phase, for results */
 
 /* verbosity settings */
 #define VERBOSE_0          0
@@ -577,7 +577,7 @@ void run_precreate(phase_stat_t * s, int current_index){
       if (NULL == aiori_fh){
         FAIL("Unable to open file %s", obj_name);
       }
-      update_write_memory_pattern(f * o.dset_count + d, buf, o.file_size, o.random_seed, o.rank, o.dataPacketType, o.gpuMemoryFlags);
+      update_write_memory_pattern(((uint64_t) f * o.dset_count + d) * o.file_size, buf, o.file_size, o.random_seed, o.rank, o.dataPacketType, o.gpuMemoryFlags);
       if ( o.file_size == (int) o.backend->xfer(WRITE, aiori_fh, (IOR_size_t *) buf, o.file_size, 0, o.backend_options)) {
         s->obj_create.suc++;
       }else{
@@ -658,7 +658,7 @@ void run_benchmark(phase_stat_t * s, int * current_index_p){
       }
       if ( o.file_size == (int) o.backend->xfer(READ, aiori_fh, (IOR_size_t *) buf, o.file_size, 0, o.backend_options) ) {
         if(o.verify_read){
-            if(verify_memory_pattern(prevFile * o.dset_count + d, buf, o.file_size, o.random_seed, readRank, o.dataPacketType, o.gpuMemoryFlags) == 0){
+            if(verify_memory_pattern(((uint64_t) prevFile * o.dset_count + d) * o.file_size, buf, o.file_size, o.random_seed, readRank, o.dataPacketType, o.gpuMemoryFlags) == 0){
               s->obj_read.suc++;
             }else{
               s->obj_read.err++;
@@ -700,7 +700,7 @@ void run_benchmark(phase_stat_t * s, int * current_index_p){
       aiori_fh = o.backend->create(obj_name, IOR_WRONLY | IOR_CREAT, o.backend_options);
       if (NULL != aiori_fh){
         generate_memory_pattern(buf, o.file_size, o.random_seed, writeRank, o.dataPacketType, o.gpuMemoryFlags);
-        update_write_memory_pattern(newFileIndex * o.dset_count + d, buf, o.file_size, o.random_seed, writeRank, o.dataPacketType, o.gpuMemoryFlags);
+        update_write_memory_pattern(((uint64_t) newFileIndex * o.dset_count + d) * o.file_size, buf, o.file_size, o.random_seed, writeRank, o.dataPacketType, o.gpuMemoryFlags);
         
         if ( o.file_size == (int) o.backend->xfer(WRITE, aiori_fh, (IOR_size_t *) buf, o.file_size, 0, o.backend_options)) {
           s->obj_create.suc++;
@@ -831,7 +831,7 @@ static option_help options [] = {
   {'w', "stonewall-timer", "Stop each benchmark iteration after the specified seconds (if not used with -W this leads to process-specific progress!)", OPTION_OPTIONAL_ARGUMENT, 'd', & o.stonewall_timer},
   {'W', "stonewall-wear-out", "Stop with stonewall after specified time and use a soft wear-out phase -- all processes perform the same number of iterations", OPTION_FLAG, 'd', & o.stonewall_timer_wear_out},
   {'X', "verify-read", "Verify the data on read", OPTION_FLAG, 'd', & o.verify_read},
-  {0, "dataPacketType", "type of packet that will be created [offset|incompressible|timestamp|random|o|i|t|r]", OPTION_OPTIONAL_ARGUMENT, 's', & o.packetTypeStr},
+  {0, "dataPacketType", "type of packet that will be created [offset|incompressible|timestamp|random|dedupe|o|i|t|r|d]", OPTION_OPTIONAL_ARGUMENT, 's', & o.packetTypeStr},
 #ifdef HAVE_CUDA
   {0, "allocateBufferOnGPU", "Allocate I/O buffers on the GPU: X=1 uses managed memory - verifications are run on CPU; X=2 managed memory - verifications on GPU; X=3 device memory with verifications on GPU.", OPTION_OPTIONAL_ARGUMENT, 'd', & o.gpuMemoryFlags},
   {0, "GPUid", "Select the GPU to use, use -1 for round-robin among local procs.", OPTION_OPTIONAL_ARGUMENT, 'd', & o.gpuID},
@@ -923,7 +923,10 @@ mdworkbench_results_t* md_workbench_run(int argc, char ** argv, MPI_Comm world_c
   }
   o.backend_options = airoi_update_module_options(o.backend, global_options);
   
-  o.dataPacketType = parsePacketType(o.packetTypeStr[0]);
+  double dedupeCompress = 1.0;
+  double dedupeFraction = 0.0;
+  o.dataPacketType = parsePacketType(o.packetTypeStr, & dedupeCompress, & dedupeFraction);
+  set_dedupe_pattern(dedupeCompress, dedupeFraction);
 
   if (!(o.phase_cleanup || o.phase_precreate || o.phase_benchmark)){
     // enable all phases
@@ -939,6 +942,7 @@ mdworkbench_results_t* md_workbench_run(int argc, char ** argv, MPI_Comm world_c
       MPI_Bcast(& o.random_seed, 1, MPI_INT, 0, o.com);
   }
 
+  o.hints.transferSize = o.file_size;
   if(o.backend->xfer_hints){
     o.backend->xfer_hints(& o.hints);
   }
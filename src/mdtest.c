@@ -366,6 +366,10 @@ static void remove_file (const char *path, uint64_t itemNum) {
     }
 }
 
+/* position of the item in the data stream of the memory pattern, the write size defines the layout */
+static uint64_t item_position (uint64_t itemNum) {
+    return itemNum * (o.write_bytes ? o.write_bytes : o.read_bytes);
+}
 
 static void create_file (const char *path, uint64_t itemNum) {
     char curr_item[MAX_PATHLEN];
@@ -415,7 +419,7 @@ static void create_file (const char *path, uint64_t itemNum) {
         VERBOSE(3,5,"create_remove_items_helper: write..." );
 
         o.hints.fsyncPerWrite = o.sync_file;
-        update_write_memory_pattern(itemNum, o.write_buffer, o.write_bytes, o.random_buffer_offset, rank, o.dataPacketType, o.gpuMemoryFlags);
+        update_write_memory_pattern(item_position(itemNum), o.write_buffer, o.write_bytes, o.random_buffer_offset, rank, o.dataPacketType, o.gpuMemoryFlags);
 
         if ( o.write_bytes != (size_t) o.backend->xfer(WRITE, aiori_fh, (IOR_size_t *) o.write_buffer, o.write_bytes, 0, o.backend_options)) {
             WARNF("unable to write file %s", curr_item);
@@ -426,7 +430,7 @@ static void create_file (const char *path, uint64_t itemNum) {
             if (o.write_bytes != (size_t) o.backend->xfer(READ, aiori_fh, (IOR_size_t *) o.write_buffer, o.write_bytes, 0, o.backend_options)) {
                 WARNF("unable to verify write (read/back) file %s", curr_item);
             }
-            int error = verify_memory_pattern(itemNum, o.write_buffer, o.write_bytes, o.random_buffer_offset, rank, o.dataPacketType, o.gpuMemoryFlags);
+            int error = verify_memory_pattern(item_position(itemNum), o.write_buffer, o.write_bytes, o.random_buffer_offset, rank, o.dataPacketType, o.gpuMemoryFlags);
             o.verification_error += error;
             if(error){
                 VERBOSE(1,1,"verification error in file: %s", curr_item);
@@ -760,7 +764,7 @@ void mdtest_read(int random, int dirs, const long dir_iter, char *path, rank_pro
               if (o.shared_file) {
                 pretend_rank = rank;
               }
-              int error = verify_memory_pattern(item_num, read_buffer, o.read_bytes, o.random_buffer_offset, pretend_rank, o.dataPacketType, o.gpuMemoryFlags);
+              int error = verify_memory_pattern(item_position(item_num), read_buffer, o.read_bytes, o.random_buffer_offset, pretend_rank, o.dataPacketType, o.gpuMemoryFlags);
               o.verification_error += error;
               if(error){
                 VERBOSE(1,1,"verification error in file: %s", item);
@@ -2344,7 +2348,7 @@ mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE *
       {'Y', NULL,        "call the sync command after each phase (included in the timing; note it causes all IO to be flushed from your node)", OPTION_FLAG, 'd', & o.call_sync},
       {'z', NULL,        "depth of hierarchical directory structure", OPTION_OPTIONAL_ARGUMENT, 'd', & o.depth},
       {'Z', NULL,        "print time instead of rate", OPTION_FLAG, 'd', & o.print_time},
-      {0, "dataPacketType", "type of packet that will be created [offset|incompressible|timestamp|random|o|i|t|r]", OPTION_OPTIONAL_ARGUMENT, 's', & packetType},
+      {0, "dataPacketType", "type of packet that will be created [offset|incompressible|timestamp|random|dedupe|o|i|t|r|d]", OPTION_OPTIONAL_ARGUMENT, 's', & packetType},
       {0, "run-cmd-before-phase", "call this external command before each phase (excluded from the timing)", OPTION_OPTIONAL_ARGUMENT, 's', & o.prologue},
       {0, "run-cmd-after-phase",  "call this external command after each phase (included in the timing)", OPTION_OPTIONAL_ARGUMENT, 's', & o.epilogue},
 #ifdef HAVE_CUDA
@@ -2372,11 +2376,15 @@ mdtest_results_t * mdtest_run(int argc, char **argv, MPI_Comm world_com, FILE *
     free(global_options->modules);
     free(global_options);
     
-    o.dataPacketType = parsePacketType(packetType[0]);
+    double dedupeCompress = 1.0;
+    double dedupeFraction = 0.0;
+    o.dataPacketType = parsePacketType(packetType, & dedupeCompress, & dedupeFraction);
+    set_dedupe_pattern(dedupeCompress, dedupeFraction);
 
     MPI_Comm_rank(testComm, &rank);
     MPI_Comm_size(testComm, &o.size);
 
+    o.hints.transferSize = o.write_bytes > o.read_bytes ? o.write_bytes : o.read_bytes;
     if(o.backend->xfer_hints){
       o.backend->xfer_hints(& o.hints);
     }
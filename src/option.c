@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <limits.h>
 
 #include <option.h>
@@ -162,6 +163,43 @@ void option_print_help(option_help * args){
   print_help_section(args, OPTION_OPTIONAL_ARGUMENT, "Optional arguments");
 }
 
+/*
+ * Returns 1 if the option is named after another module, e.g., the POSIX
+ * options embedded in the options of other backends.
+ */
+static int option_of_other_module(options_all_t * opt_all, int m, option_help * o){
+  if(o->longVar == NULL || strchr(o->longVar, '.') == NULL){
+    return 0;
+  }
+  size_t len = strchr(o->longVar, '.') - o->longVar;
+  for(int i = 0; i < opt_all->module_count; i++){
+    char * prefix = opt_all->modules[i].prefix;
+    if(i != m && prefix != NULL && strlen(prefix) == len && strncasecmp(prefix, o->longVar, len) == 0){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* print the help of a module without the options that are listed by another module */
+static void option_print_module_help(options_all_t * opt_all, int m){
+  option_help * args = opt_all->modules[m].options;
+  int count = 0;
+  for(option_help * o = args; o->shortVar != 0 || o->longVar != 0 || o->help != NULL ; o++){
+    count++;
+  }
+  option_help * own = malloc(sizeof(option_help) * (count + 1));
+  int pos = 0;
+  for(option_help * o = args; o->shortVar != 0 || o->longVar != 0 || o->help != NULL ; o++){
+    if(! option_of_other_module(opt_all, m, o)){
+      own[pos++] = *o;
+    }
+  }
+  memset(& own[pos], 0, sizeof(option_help));
+  option_print_help(own);
+  free(own);
+}
+
 
 static int print_option_value(option_help * o){
   int pos = 0;
@@ -248,6 +286,7 @@ void option_print_current(option_help * args){
 static void option_parse_token(char ** argv, int * flag_parsed_next, int * requiredArgsSeen, options_all_t * opt_all, int * error, int * print_help){
   char * txt = argv[0];
   char * arg = strstr(txt, "=");
+  char * equal = arg;
 
   int replaced_equal = 0;
   int i = 0;
@@ -367,10 +406,6 @@ static void option_parse_token(char ** argv, int * flag_parsed_next, int * requi
               }
             }
           }
-          if(replaced_equal){
-            arg[-1] = '=';
-          }
-
           if(o->arg == OPTION_REQUIRED_ARGUMENT){
             (*requiredArgsSeen)++;
           }
@@ -380,6 +415,10 @@ static void option_parse_token(char ** argv, int * flag_parsed_next, int * requi
       }
     }
   }
+  /* the option may be set by multiple modules, e.g., the POSIX options embedded in other backends */
+  if(replaced_equal){
+    equal[0] = '=';
+  }
   if(parsed) return;
   
   if(strcmp(txt, "h") == 0 || strcmp(txt, "-help") == 0){
@@ -458,7 +497,7 @@ int option_parse(int argc, char ** argv, options_all_t * opt_all){
       if(prefix != NULL){
         printf("\n\nModule %s\n", prefix);
       }
-      option_print_help(args);
+      option_print_module_help(opt_all, m);
     }
     exit(EXIT_FAILURE);
   }
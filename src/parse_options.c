@@ -130,6 +130,14 @@ void DecodeDirective(char *line, IOR_param_t *params, options_all_t * module_opt
                 }else{
                   FAIL("Unknown summaryFormat");
                 }
+        } else if (strcasecmp(option, "timer") == 0) {
+                if(strcasecmp(value, "monotonic") == 0){
+                  timerTSC = 0;
+                }else if(strcasecmp(value, "TSC") == 0){
+                  timerTSC = 1;
+                }else{
+                  FAIL("Unknown timer");
+                }
         } else if (strcasecmp(option, "refnum") == 0) {
                 params->referenceNumber = atoi(value);
         } else if (strcasecmp(option, "debug") == 0) {
@@ -152,6 +160,8 @@ void DecodeDirective(char *line, IOR_param_t *params, options_all_t * module_opt
                 params->stoneWallingWearOut = atoi(value);
         } else if (strcasecmp(option, "stoneWallingWearOutIterations") == 0) {
                 params->stoneWallingWearOutIterations = atoll(value);
+        } else if (strcasecmp(option, "stoneWallingAgreementInterval") == 0) {
+                params->stoneWallingAgreementInterval = atoi(value);
         } else if (strcasecmp(option, "stoneWallingStatusFile") == 0) {
                 params->stoneWallingStatusFile  = strdup(value);
         } else if (strcasecmp(option, "maxtimeduration") == 0) {
@@ -172,6 +182,44 @@ void DecodeDirective(char *line, IOR_param_t *params, options_all_t * module_opt
                 params->interTestDelay = atoi(value);
         } else if (strcasecmp(option, "interiodelay") == 0) {
                 params->interIODelay = atoi(value);
+        } else if (strcasecmp(option, "queueDepth") == 0) {
+                params->queueDepth = atoi(value);
+        } else if (strcasecmp(option, "verifyThreads") == 0) {
+                params->verifyThreads = atoi(value);
+        } else if (strcasecmp(option, "threadsPerRank") == 0) {
+                params->threadsPerRank = atoi(value);
+        } else if (strcasecmp(option, "sampleInterval") == 0) {
+                params->sampleInterval = atof(value);
+        } else if (strcasecmp(option, "targetIOPS") == 0) {
+                params->targetIOPS = atof(value);
+        } else if (strcasecmp(option, "targetBandwidth") == 0) {
+                params->targetBandwidth = string_to_bytes(value);
+        } else if (strcasecmp(option, "cacheControl") == 0) {
+                params->cacheControl = strdup(value);
+        } else if (strcasecmp(option, "cacheResidency") == 0) {
+                params->cacheResidency = atoi(value);
+        } else if (strcasecmp(option, "offsetDistribution") == 0) {
+                params->offsetDistribution = strdup(value);
+        } else if (strcasecmp(option, "transferSizes") == 0) {
+                params->transferSizes = strdup(value);
+        } else if (strcasecmp(option, "extentSize") == 0) {
+                params->extentSize = string_to_bytes(value);
+        } else if (strcasecmp(option, "fileHole") == 0) {
+                params->fileHole = string_to_bytes(value);
+        } else if (strcasecmp(option, "memoryHole") == 0) {
+                params->memoryHole = string_to_bytes(value);
+        } else if (strcasecmp(option, "layout") == 0) {
+                params->layout = strdup(value);
+        } else if (strcasecmp(option, "rwmix") == 0) {
+                params->rwmix = atoi(value);
+        } else if (strcasecmp(option, "targetArrivals") == 0) {
+                if(strcasecmp(value, "constant") == 0){
+                  params->targetPoisson = 0;
+                }else if(strcasecmp(value, "poisson") == 0){
+                  params->targetPoisson = 1;
+                }else{
+                  FAIL("Unknown targetArrivals");
+                }
         } else if (strcasecmp(option, "readfile") == 0) {
                 params->readFile = atoi(value);
         } else if (strcasecmp(option, "writefile") == 0) {
@@ -219,7 +267,9 @@ void DecodeDirective(char *line, IOR_param_t *params, options_all_t * module_opt
         } else if (strcasecmp(option, "settimestampsignature") == 0) {
                 params->setTimeStampSignature = atoi(value);
         } else if (strcasecmp(option, "dataPacketType") == 0) {
-                params->dataPacketType = parsePacketType(value[0]);
+                params->dataPacketType = parsePacketType(value, & params->dedupeCompress, & params->dedupeFraction);
+        } else if (strcasecmp(option, "ranksPerFile") == 0 || strcasecmp(option, "filesPerGroup") == 0) {
+                params->ranksPerFile = atoi(value);
         } else if (strcasecmp(option, "uniqueDir") == 0) {
                 params->uniqueDir = atoi(value);
         } else if (strcasecmp(option, "useexistingtestfile") == 0) {
@@ -424,8 +474,26 @@ option_help * createGlobalOptions(IOR_param_t * params){
     {'D', NULL,        "deadlineForStonewalling -- seconds before stopping write or read phase", OPTION_OPTIONAL_ARGUMENT, 'd', & params->deadlineForStonewalling},
     {.help="  -O stoneWallingWearOut=1           -- once the stonewalling timeout is over, all process finish to access the amount of data", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O stoneWallingWearOutIterations=N -- stop after processing this number of iterations, needed for reading data back written with stoneWallingWearOut", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O stoneWallingAgreementInterval=K -- with collective I/O, the processes agree every K transfers with a non-blocking reduction whether the stonewall is hit", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O stoneWallingStatusFile=FILE     -- this file keeps the number of iterations from stonewalling during write and allows to use them for read", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O minTimeDuration=0           -- minimum Runtime for the run (will repeat from beginning of the file if time is not yet over)", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O queueDepth=N                    -- keep N transfers in flight, each with its own buffer; requires a backend supporting asynchronous transfers", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O threadsPerRank=N                -- perform the I/O of each process with N threads, each accessing a disjoint part of every block; requires a thread-safe backend", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O verifyThreads=N                 -- verify the data of -W and -R with N threads while the next transfers are read", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O cacheControl=[fadvise,syncfs]   -- before -W and -r drop the cached data of the test files with fdatasync() and posix_fadvise(DONTNEED) and/or flush their file system with syncfs(), combine with +", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O cacheResidency=1                -- before -W and -r report the fraction of the test files held in the cache of the readers", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O sampleInterval=S                -- report the throughput of all processes for every interval of S seconds of a phase in the JSON and CSV output", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O offsetDistribution=[uniform,zipf:E,hotspot:D/A,pareto[:H]] -- with -z draw the transfers from a skewed distribution, e.g., zipf:0.99 or hotspot:10/90 for 90% of the accesses to 10% of the data", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O transferSizes=SIZES             -- tile each block with transfers of varying size, either a list of sizes with optional weights, e.g., 4k:3+1m:1, or a log-uniform range, e.g., 4k-4m; -t is set to the largest size", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O extentSize=S                    -- access every transfer as extents of S bytes with a single vectored call, e.g., preadv()", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O fileHole=H                      -- with extentSize, skip H bytes in the file after every extent", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O memoryHole=H                    -- with extentSize, skip H bytes in the buffer after every extent", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O layout=Nd:DIMS:GRID[:ES[:BLK]]  -- access a shared file as a row-major N-d array of ES-byte elements decomposed block-cyclically on a process grid, e.g., 3d:1024x1024x512:8x8x4", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O ranksPerFile=K                  -- groups of K consecutive processes share a file (N-to-M), 1 is -F, alias filesPerGroup", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O rwmix=P                         -- add a phase after the write phase in which each transfer is a read with probability P percent and a write otherwise, reads and writes are reported separately", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O targetIOPS=N                    -- issue N transfers per second summed over all processes on a fixed schedule (open loop), the latency includes the time a transfer is behind schedule", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O targetBandwidth=B               -- like targetIOPS for a bandwidth of B bytes per second (e.g.: 100m, 2g)", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O targetArrivals=[constant,poisson] -- distribution of the start times of transfers for targetIOPS and targetBandwidth", .arg = OPTION_OPTIONAL_ARGUMENT},
 #ifdef HAVE_CUDA
     {.help="  -O allocateBufferOnGPU=X           -- allocate I/O buffers on the GPU: X=1 uses managed memory - verifications are run on CPU; X=2 managed memory - verifications on GPU; X=3 device memory with verifications on GPU.", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O GPUid=X                         -- select the GPU to use, use -1 for round-robin among local procs.", .arg = OPTION_OPTIONAL_ARGUMENT},
@@ -447,7 +515,7 @@ option_help * createGlobalOptions(IOR_param_t * params){
     {'j', NULL,        "outlierThreshold -- warn on outlier N seconds from mean", OPTION_OPTIONAL_ARGUMENT, 'd', & params->outlierThreshold},
     {'k', NULL,        "keepFile -- don't remove the test file(s) on program exit", OPTION_FLAG, 'd', & params->keepFile},
     {'K', NULL,        "keepFileWithError  -- keep error-filled file(s) after data-checking", OPTION_FLAG, 'd', & params->keepFileWithError},
-    {'l', "dataPacketType",        "datapacket type-- type of packet that will be created [offset|incompressible|timestamp|random|o|i|t|r]", OPTION_OPTIONAL_ARGUMENT, 's', &  params->buffer_type},
+    {'l', "dataPacketType",        "datapacket type-- type of packet that will be created [offset|incompressible|timestamp|random|dedupe|o|i|t|r|d], dedupe accepts ratios, e.g., dedupe:compress=2.0:dedupe=0.3", OPTION_OPTIONAL_ARGUMENT, 's', &  params->buffer_type},
     {'m', NULL,        "multiFile -- use number of reps (-i) for multiple file count", OPTION_FLAG, 'd', & params->multiFile},
     {'M', NULL,        "memoryPerNode -- hog memory on the node  (e.g.: 2g, 75%)", OPTION_OPTIONAL_ARGUMENT, 's', & params->memoryPerNodeStr},
     {'N', NULL,        "numTasks -- number of tasks that are participating in the test (overrides MPI)", OPTION_OPTIONAL_ARGUMENT, 'd', & params->numTasks},
@@ -474,6 +542,7 @@ option_help * createGlobalOptions(IOR_param_t * params){
     {0, "warningAsErrors",        "Any warning should lead to an error.", OPTION_FLAG, 'd', & params->warningAsErrors},
     {.help="  -O summaryFile=FILE                 -- store result data into this file", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O summaryFormat=[default,JSON,CSV] -- use the format for outputting the summary", .arg = OPTION_OPTIONAL_ARGUMENT},
+    {.help="  -O timer=[monotonic,TSC]            -- clock for time stamps, TSC uses the calibrated time stamp counter of x86-64 CPUs", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O saveRankPerformanceDetailsCSV=<FILE> -- store the performance of each rank into the named CSV file.", .arg = OPTION_OPTIONAL_ARGUMENT},
     {.help="  -O savePerOpDataCSV=<FILE> -- store the performance of each rank into an individual file prefixed with this option.", .arg = OPTION_OPTIONAL_ARGUMENT},
     {0, "dryRun",      "do not perform any I/Os just run evtl. inputs print dummy output", OPTION_FLAG, 'd', & params->dryRun},
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../utilities.h"
+
+/* fraction of draws that hit the ranks [0, hot) */
+static double hot_fraction(const char * spec, uint64_t count, uint64_t hot, uint64_t draws){
+  skewed_distribution_t dist;
+  uint64_t hits = 0;
+
+  if(skewed_distribution_parse(& dist, spec) != 0){
+    fprintf(stderr, "Cannot parse %s\n", spec);
+    exit(1);
+  }
+  skewed_distribution_init(& dist, count, 42);
+  for(uint64_t i = 0; i < draws; i++){
+    uint64_t rank = skewed_distribution_get(& dist, i);
+    if(rank >= count){
+      fprintf(stderr, "%s returned %llu out of range\n", spec, (unsigned long long) rank);
+      exit(1);
+    }
+    if(rank != skewed_distribution_get(& dist, i)){
+      fprintf(stderr, "%s is not deterministic\n", spec);
+      exit(1);
+    }
+    hits += rank < hot;
+  }
+  return (double) hits / draws;
+}
+
+static int check(const char * spec, uint64_t count, uint64_t hot, double expected){
+  double fraction = hot_fraction(spec, count, hot, 200000);
+  if(fabs(fraction - expected) > 0.01){
+    fprintf(stderr, "%s: %f of the draws to the %llu hottest ranks, expected %f\n", spec, fraction, (unsigned long long) hot, expected);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char ** argv){
+  int ret = 0;
+  skewed_distribution_t dist;
+
+  ret |= check("uniform", 1000, 100, 0.1);
+  ret |= check("hotspot:10/90", 1000, 100, 0.9);
+  ret |= check("pareto", 1000, 200, 0.8);
+  ret |= check("pareto:0.1", 1000, 100, 0.9);
+  /* the most frequent rank of Zipf with exponent 1 has the probability 1 / H_n */
+  double harmonic = 0;
+  for(int i = 1; i <= 1000; i++){
+    harmonic += 1.0 / i;
+  }
+  ret |= check("zipf:1", 1000, 1, 1 / harmonic);
+  ret |= check("zipf:0.99", 1, 1, 1.0);
+
+  if(skewed_distribution_parse(& dist, "zipf:0") == 0 || skewed_distribution_parse(& dist, "hotspot:10") == 0
+     || skewed_distribution_parse(& dist, "pareto:1") == 0 || skewed_distribution_parse(& dist, "gauss") == 0){
+    fprintf(stderr, "Invalid distributions are accepted\n");
+    ret = 1;
+  }
+
+  /* transfer sizes follow the weights of a list and stay within a range */
+  size_distribution_t sizes;
+  if(size_distribution_parse(& sizes, "4k:3+1m") != 0 || sizes.min != 4096 || sizes.max != 1048576
+     || size_distribution_get(& sizes, 0.7) != 4096 || size_distribution_get(& sizes, 0.8) != 1048576){
+    fprintf(stderr, "Wrong transfer sizes of a list\n");
+    ret = 1;
+  }
+  if(size_distribution_parse(& sizes, "4k-4m") != 0){
+    fprintf(stderr, "Cannot parse a range of transfer sizes\n");
+    ret = 1;
+  }
+  uint64_t small = 0;
+  for(int i = 0; i < 1000; i++){
+    uint64_t size = size_distribution_get(& sizes, i / 1000.0);
+    if(size < 4096 || size > 4194304 || size % 4096 != 0){
+      fprintf(stderr, "Transfer size %llu outside of the range\n", (unsigned long long) size);
+      ret = 1;
+    }
+    small += size < 65536;
+  }
+  /* log-uniform: 4 of the 10 doublings are below 64k */
+  if(small < 350 || small > 450){
+    fprintf(stderr, "%llu of the transfer sizes are below 64k\n", (unsigned long long) small);
+    ret = 1;
+  }
+  if(size_distribution_parse(& sizes, "4k+6k") == 0 || size_distribution_parse(& sizes, "4k:0") == 0
+     || size_distribution_parse(& sizes, "8k-4k") == 0 || size_distribution_parse(& sizes, "") == 0){
+    fprintf(stderr, "Invalid transfer sizes are accepted\n");
+    ret = 1;
+  }
+
+  /* the estimate of distinct items is within a few standard errors */
+  uint64_t counts[] = {10, 1000, 1000000};
+  for(int i = 0; i < sizeof(counts) / sizeof(uint64_t); i++){
+    UniqueCounter * a = UniqueCounterInit();
+    UniqueCounter * b = UniqueCounterInit();
+    for(uint64_t j = 0; j < counts[i]; j++){
+      UniqueCounterValue(j % 2 ? a : b, j * 4096);
+      UniqueCounterValue(a, j * 4096);
+    }
+    UniqueCounterMerge(a, b);
+    double estimate = UniqueCounterEstimate(a);
+    if(fabs(estimate - counts[i]) > 0.05 * counts[i] + 1){
+      fprintf(stderr, "Estimate of %llu distinct items is %f\n", (unsigned long long) counts[i], estimate);
+      ret = 1;
+    }
+    UniqueCounterFree(& a);
+    UniqueCounterFree(& b);
+  }
+  return ret;
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../utilities.h"
+
+/* the percentiles of values 1..count us must be within the relative error of the histogram */
+static int check_percentiles(LatencyHistogram * h, uint64_t count){
+  double fractions[] = {0.01, 0.5, 0.9, 0.99, 0.999};
+  int ret = 0;
+
+  for(int i = 0; i < sizeof(fractions) / sizeof(double); i++){
+    double expected = ceil(fractions[i] * count) * 1e-6;
+    double value = LatencyHistogramPercentile(h, fractions[i]);
+    if(fabs(value - expected) > expected / 128){
+      fprintf(stderr, "Percentile %f is %e expected %e\n", fractions[i], value, expected);
+      ret = 1;
+    }
+  }
+  if(fabs(LatencyHistogramPercentile(h, 1.0) - count * 1e-6) > 1e-9){
+    fprintf(stderr, "Maximum is %e expected %e\n", LatencyHistogramPercentile(h, 1.0), count * 1e-6);
+    ret = 1;
+  }
+  return ret;
+}
+
+int main(int argc, char ** argv){
+  uint64_t count = 100000;
+  int ret = 0;
+
+  MPI_Init(& argc, & argv);
+
+  /* values split across two histograms must merge into the same result */
+  LatencyHistogram * a = LatencyHistogramInit();
+  LatencyHistogram * b = LatencyHistogramInit();
+  for(uint64_t i = 1; i <= count; i++){
+    LatencyHistogramValue(i % 2 ? a : b, i * 1e-6);
+  }
+  LatencyHistogramMerge(a, b);
+  if(LatencyHistogramCount(a) != count){
+    fprintf(stderr, "Merged histogram counts %llu values\n", (unsigned long long) LatencyHistogramCount(a));
+    ret = 1;
+  }
+  ret |= check_percentiles(a, count);
+
+  LatencyHistogram * r = LatencyHistogramReduce(a, 0, MPI_COMM_WORLD);
+  ret |= check_percentiles(r, count);
+
+  /* values beyond the range of the buckets keep the maximum */
+  LatencyHistogramValue(r, 1e6);
+  if(fabs(LatencyHistogramPercentile(r, 1.0) - 1e6) > 1e-3 || LatencyHistogramPercentile(r, 0.5) > 1){
+    fprintf(stderr, "Out of range value is not accounted correctly\n");
+    ret = 1;
+  }
+
+  LatencyHistogramFree(& a);
+  LatencyHistogramFree(& b);
+  LatencyHistogramFree(& r);
+  MPI_Finalize();
+  return ret;
+}
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utilities.h"
+
+/* every byte of the global array belongs to exactly one process */
+static int check(const char * spec, uint64_t run){
+  array_layout_t layout;
+
+  if(array_layout_parse(& layout, spec) != 0){
+    fprintf(stderr, "Cannot parse %s\n", spec);
+    return 1;
+  }
+  uint64_t processes = array_layout_processes(& layout);
+  uint64_t local = array_layout_local_size(& layout);
+  uint64_t size = processes * local;
+  char * hit = calloc(size, 1);
+  int ret = 0;
+
+  if(array_layout_run_size(& layout) != run){
+    fprintf(stderr, "%s: runs of %llu bytes, expected %llu\n", spec,
+            (unsigned long long) array_layout_run_size(& layout), (unsigned long long) run);
+    ret = 1;
+  }
+  for(uint64_t rank = 0; rank < processes; rank++){
+    for(uint64_t offset = 0; offset < local; offset++){
+      uint64_t pos = array_layout_offset(& layout, rank, offset);
+      if(pos >= size || hit[pos]){
+        fprintf(stderr, "%s: rank %llu offset %llu is mapped to %llu twice or outside the array\n", spec,
+                (unsigned long long) rank, (unsigned long long) offset, (unsigned long long) pos);
+        free(hit);
+        return 1;
+      }
+      hit[pos] = 1;
+      /* the bytes of a run are contiguous in the array */
+      if(offset % run != 0 && pos != array_layout_offset(& layout, rank, offset - 1) + 1){
+        fprintf(stderr, "%s: run at offset %llu is not contiguous\n", spec, (unsigned long long) offset);
+        ret = 1;
+      }
+    }
+  }
+  free(hit);
+  return ret;
+}
+
+int main(int argc, char ** argv){
+  int ret = 0;
+  array_layout_t layout;
+
+  ret |= check("1d:1024:4", 2048);
+  ret |= check("2d:64x32:2x4:4", 32);
+  ret |= check("3d:16x16x8:2x2x2:8", 32);
+  ret |= check("3d:16x16x8:1x4x1:2", 64);
+  ret |= check("2d:64x64:2x2:8:4x8", 64);
+  ret |= check("4d:4x8x8x4:1x2x2x1:1:1x2x1x4", 4);
+
+  /* rank 1 of a 2x2 grid owns the upper right quarter */
+  array_layout_parse(& layout, "2d:4x4:2x2:1");
+  if(array_layout_offset(& layout, 1, 0) != 2 || array_layout_offset(& layout, 1, 2) != 6){
+    fprintf(stderr, "Wrong placement of the sub-array of rank 1\n");
+    ret = 1;
+  }
+
+  if(array_layout_parse(& layout, "3d:64x64:2x2") == 0 || array_layout_parse(& layout, "2d:10x10:3x1") == 0
+     || array_layout_parse(& layout, "2d:64x64:2x2:8:8x3") == 0 || array_layout_parse(& layout, "2:64x64:2x2") == 0
+     || array_layout_parse(& layout, "2d:64x64") == 0 || array_layout_parse(& layout, "2d:64x0:1x1") == 0){
+    fprintf(stderr, "Invalid layouts are accepted\n");
+    ret = 1;
+  }
+  return ret;
+}
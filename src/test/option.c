@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../option.h"
+
+typedef struct{
+  char * engine;
+  int depth;
+  int nowait;
+} module_options_t;
+
+static int check_module(char * name, module_options_t * o){
+  if(o->engine == NULL || strcmp(o->engine, "pread") != 0){
+    fprintf(stderr, "Module %s has engine %s expected pread\n", name, o->engine ? o->engine : "(null)");
+    return 1;
+  }
+  if(o->depth != 4){
+    fprintf(stderr, "Module %s has depth %d expected 4\n", name, o->depth);
+    return 1;
+  }
+  if(o->nowait != 1){
+    fprintf(stderr, "Module %s has nowait %d expected 1\n", name, o->nowait);
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char ** argv){
+  int ret = 0;
+  module_options_t posix = {NULL, 1, 0};
+  module_options_t mmap = {NULL, 1, 0};
+
+  /* the POSIX options are embedded in the options of other backends, e.g., MMAP */
+  option_help posix_options[] = {
+    {0, "posix.engine", "The engine", OPTION_OPTIONAL_ARGUMENT, 's', & posix.engine},
+    {0, "posix.depth", "The depth", OPTION_OPTIONAL_ARGUMENT, 'd', & posix.depth},
+    {0, "posix.nowait", "No wait", OPTION_FLAG, 'd', & posix.nowait},
+    LAST_OPTION
+  };
+  option_help mmap_options[] = {
+    {0, "posix.engine", "The engine", OPTION_OPTIONAL_ARGUMENT, 's', & mmap.engine},
+    {0, "posix.depth", "The depth", OPTION_OPTIONAL_ARGUMENT, 'd', & mmap.depth},
+    {0, "posix.nowait", "No wait", OPTION_FLAG, 'd', & mmap.nowait},
+    LAST_OPTION
+  };
+  option_module modules[] = {
+    {"POSIX", posix_options, NULL},
+    {"MMAP", mmap_options, NULL}
+  };
+  options_all_t opt_all = {2, modules};
+
+  /* every module must receive the value, in both the key=value and the key value form */
+  char engine[] = "--posix.engine=pread";
+  char depth[] = "--posix.depth";
+  char depth_value[] = "4";
+  char nowait[] = "--posix.nowait";
+  char * args[] = {"test", engine, depth, depth_value, nowait, NULL};
+  int parsed = option_parse(5, args, & opt_all);
+  if(parsed != 5){
+    fprintf(stderr, "Parsed %d arguments expected 5\n", parsed);
+    ret = 1;
+  }
+  ret |= check_module("POSIX", & posix);
+  ret |= check_module("MMAP", & mmap);
+
+  /* the argument is left intact for other parsers */
+  if(strcmp(engine, "--posix.engine=pread") != 0){
+    fprintf(stderr, "The argument was modified to %s\n", engine);
+    ret = 1;
+  }
+
+  /* a single key value pair, e.g., from a script, reaches every module as well */
+  posix.engine = NULL;
+  mmap.engine = NULL;
+  if(option_parse_key_value("--posix.engine", "pread", & opt_all) != 0){
+    fprintf(stderr, "Error parsing the key value pair\n");
+    ret = 1;
+  }
+  ret |= check_module("POSIX", & posix);
+  ret |= check_module("MMAP", & mmap);
+
+  if(ret == 0){
+    printf("OK\n");
+  }
+  return ret;
+}
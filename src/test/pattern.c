@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utilities.h"
+
+/*
+ * Checks that the data patterns verify and that a corrupted byte is detected,
+ * then reports the throughput of generating and verifying each packet type.
+ */
+
+#define BUFFER_SIZE (1024*1024 + 5)
+#define BENCH_BYTES (256ll*1024*1024)
+
+static const char * type_names[] = {"timestamp", "offset", "incompressible", "random", "dedupe"};
+
+static int check(char * buf, ior_dataPacketType_e type){
+  size_t positions[] = {0, 7, 8, 4096, 4097, 12345, BUFFER_SIZE - 9, BUFFER_SIZE - 1};
+  int ret = 0;
+
+  generate_memory_pattern(buf, BUFFER_SIZE, 42, 3, type, IOR_MEMORY_TYPE_CPU);
+  update_write_memory_pattern(4711, buf, BUFFER_SIZE, 42, 3, type, IOR_MEMORY_TYPE_CPU);
+  if(verify_memory_pattern(4711, buf, BUFFER_SIZE, 42, 3, type, IOR_MEMORY_TYPE_CPU) != 0){
+    fprintf(stderr, "%s: the generated pattern does not verify\n", type_names[type]);
+    ret = 1;
+  }
+  if(type != DATA_TIMESTAMP && verify_memory_pattern(4712, buf, BUFFER_SIZE, 42, 3, type, IOR_MEMORY_TYPE_CPU) == 0){
+    fprintf(stderr, "%s: a wrong item is not detected\n", type_names[type]);
+    ret = 1;
+  }
+  for(int i = 0; i < sizeof(positions) / sizeof(size_t); i++){
+    buf[positions[i]] ^= 0x10;
+    if(verify_memory_pattern(4711, buf, BUFFER_SIZE, 42, 3, type, IOR_MEMORY_TYPE_CPU) == 0){
+      fprintf(stderr, "%s: corruption at byte %zu is not detected\n", type_names[type], positions[i]);
+      ret = 1;
+    }
+    buf[positions[i]] ^= 0x10;
+  }
+  return ret;
+}
+
+/* check the dedupe saving (1 - distinct / total blocks) across two ranks and the fraction of zeros */
+static int check_dedupe(void){
+  const int blocks = 4096;
+  char * buf = aligned_buffer_alloc(blocks * 4096, IOR_MEMORY_TYPE_CPU);
+  uint64_t * words = (uint64_t *) buf;
+  int distinct = 0;
+  size_t zeros = 0;
+  int ret = 0;
+
+  update_write_memory_pattern(0, buf, blocks / 2 * 4096, 42, 0, DATA_DEDUPE, IOR_MEMORY_TYPE_CPU);
+  update_write_memory_pattern(0, buf + blocks / 2 * 4096, blocks / 2 * 4096, 42, 1, DATA_DEDUPE, IOR_MEMORY_TYPE_CPU);
+  for(int i = 0; i < blocks; i++){
+    int j;
+    for(j = 0; j < i; j++){
+      if(memcmp(buf + i * 4096, buf + j * 4096, 4096) == 0){
+        break;
+      }
+    }
+    distinct += j == i;
+  }
+  for(size_t i = 0; i < blocks * 512; i++){
+    zeros += words[i] == 0;
+  }
+  printf("dedupe: %.3f saving, %.3f zeros\n", 1.0 - (double) distinct / blocks, (double) zeros / (blocks * 512));
+  if(distinct < 0.65 * blocks || distinct > 0.75 * blocks || zeros != blocks * 256){
+    fprintf(stderr, "dedupe: the ratios are not met\n");
+    ret = 1;
+  }
+  aligned_buffer_free(buf, IOR_MEMORY_TYPE_CPU);
+  return ret;
+}
+
+static void bench(char * buf, ior_dataPacketType_e type){
+  size_t bytes = BUFFER_SIZE - 5;
+  long long reps = BENCH_BYTES / bytes;
+  double t_start, t_generate, t_update, t_verify;
+
+  t_start = GetTimeStamp();
+  for(long long i = 0; i < reps; i++){
+    generate_memory_pattern(buf, bytes, 42, 3, type, IOR_MEMORY_TYPE_CPU);
+  }
+  t_generate = GetTimeStamp() - t_start;
+  t_start = GetTimeStamp();
+  for(long long i = 0; i < reps; i++){
+    update_write_memory_pattern(i, buf, bytes, 42, 3, type, IOR_MEMORY_TYPE_CPU);
+  }
+  t_update = GetTimeStamp() - t_start;
+  t_start = GetTimeStamp();
+  for(long long i = 0; i < reps; i++){
+    verify_memory_pattern(reps - 1, buf, bytes, 42, 3, type, IOR_MEMORY_TYPE_CPU);
+  }
+  t_verify = GetTimeStamp() - t_start;
+  printf("%-15s verify: %8.2f GB/s", type_names[type], reps * bytes / t_verify / 1e9);
+  if(type == DATA_TIMESTAMP || type == DATA_OFFSET){
+    printf(" generate: %8.2f GB/s", reps * bytes / t_generate / 1e9);
+  }
+  if(type != DATA_TIMESTAMP){
+    printf(" update: %8.2f GB/s", reps * bytes / t_update / 1e9);
+  }
+  printf("\n");
+}
+
+int main(int argc, char ** argv){
+  char * buf = aligned_buffer_alloc(BUFFER_SIZE, IOR_MEMORY_TYPE_CPU);
+  int ret = 0;
+
+#ifdef __x86_64__
+  printf("CPU: avx512f=%d avx2=%d\n", __builtin_cpu_supports("avx512f") != 0, __builtin_cpu_supports("avx2") != 0);
+#endif
+  set_dedupe_pattern(2.0, 0.3);
+  for(int t = DATA_TIMESTAMP; t <= DATA_DEDUPE; t++){
+    ret |= check(buf, t);
+  }
+  ret |= check_dedupe();
+  for(int t = DATA_TIMESTAMP; t <= DATA_DEDUPE; t++){
+    bench(buf, t);
+  }
+  aligned_buffer_free(buf, IOR_MEMORY_TYPE_CPU);
+  return ret;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../utilities.h"
+
+/* check that random_permutation_get() is a bijection for a few domain sizes */
+static int check(uint64_t count, uint64_t seed){
+  random_permutation_t perm;
+  char * seen = calloc(count, 1);
+  int ret = 0;
+
+  random_permutation_init(& perm, count, seed);
+  for(uint64_t i = 0; i < count; i++){
+    uint64_t v = random_permutation_get(& perm, i);
+    if(v >= count || seen[v]){
+      fprintf(stderr, "Permutation of %llu elements with seed %llu is not a bijection at %llu\n", (unsigned long long) count, (unsigned long long) seed, (unsigned long long) i);
+      ret = 1;
+      break;
+    }
+    seen[v] = 1;
+  }
+  free(seen);
+  return ret;
+}
+
+int main(int argc, char ** argv){
+  uint64_t counts[] = {1, 2, 3, 4, 5, 17, 64, 1000, 65537, 1000003};
+  int ret = 0;
+
+  for(int i = 0; i < sizeof(counts) / sizeof(uint64_t); i++){
+    ret |= check(counts[i], 0);
+    ret |= check(counts[i], 4711 + i);
+  }
+  return ret;
+}
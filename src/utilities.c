@@ -33,6 +33,9 @@
 #include <fcntl.h>
 #include <math.h>               /* pow() */
 #include <string.h>
+#if defined(HAVE_STRINGS_H)
+#include <strings.h>
+#endif
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -54,13 +57,17 @@
 #  include <sys/time.h>           /* gettimeofday() */
 #endif
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#  include <cpuid.h>              /* invariant TSC detection */
+#  include <x86intrin.h>          /* __rdtsc() */
+#  define HAVE_TSC_TIMER
+#endif
+
 #include "utilities.h"
 #include "aiori.h"
 #include "ior.h"
 #include "ior-internal.h"
 
-#define RANDALGO_GOLDEN_RATIO_PRIME        0x9e37fffffffc0001UL
-
 /************************** D E C L A R A T I O N S ***************************/
 
 extern int errno;
@@ -74,6 +81,7 @@ MPI_Comm testComm = MPI_COMM_NULL;
 FILE * out_logfile = NULL;
 FILE * out_resultfile = NULL;
 enum OutputFormat_t outputFormat;
+int      timerTSC = 0;               /* use the time stamp counter for GetTimeStamp() */
 
 /* local */
 //int rand_state_init = 0;
@@ -81,10 +89,219 @@ enum OutputFormat_t outputFormat;
 
 /***************************** F U N C T I O N S ******************************/
 
+/*
+ * The kernels below compare/fill 512 bit per iteration using vector extensions.
+ * On x86-64 they are compiled for AVX-512, AVX2 and the SSE2 baseline, the
+ * variant matching the CPU is selected at runtime.
+ */
+#if defined(__x86_64__) && defined(__has_attribute)
+#  if __has_attribute(target_clones)
+#    define PATTERN_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#  endif
+#endif
+#ifndef PATTERN_KERNEL
+#  define PATTERN_KERNEL
+#endif
+
+/* every PATTERN_STAMP_WORDS 64-bit word carries the item for DATA_OFFSET and DATA_INCOMPRESSIBLE */
+#define PATTERN_STAMP_WORDS 512
+#define PATTERN_VEC_WORDS 8
+#define PATTERN_GAMMA 0x9e3779b97f4a7c15ULL
+
+typedef uint64_t pattern_vec_t __attribute__((vector_size(PATTERN_VEC_WORDS * sizeof(uint64_t))));
+
+/* splitmix64 finalizer, applicable to scalars and vectors */
+#define MIX64(x) do{                    \
+    x ^= x >> 30;                       \
+    x *= 0xbf58476d1ce4e5b9ULL;         \
+    x ^= x >> 27;                       \
+    x *= 0x94d049bb133111ebULL;         \
+    x ^= x >> 31;                       \
+  }while(0)
+
+static inline uint64_t mix64(uint64_t x){
+  MIX64(x);
+  return x;
+}
+
+static inline uint64_t pattern_stamp(uint64_t item, size_t word, uint64_t stamp_hi){
+  return ((uint32_t) item * (uint32_t) (word / PATTERN_STAMP_WORDS + 1)) | stamp_hi;
+}
+
+/*
+ * Word i of a pattern is derived from the sequence cur = base + i * step.
+ * DATA_OFFSET and DATA_TIMESTAMP store hi | cur, DATA_RANDOM and
+ * DATA_INCOMPRESSIBLE are scrambled and store mix64(cur), i.e., a counter-based
+ * generator: any word can be computed independently of the others.
+ */
+#define PATTERN_WORD(x, hi, scramble) do{ \
+    if(scramble){                         \
+      MIX64(x);                           \
+    }else{                                \
+      x |= hi;                            \
+    }                                     \
+  }while(0)
+
+PATTERN_KERNEL static void fill_words(uint64_t * buf, size_t size, uint64_t hi, uint64_t base, uint64_t step, int scramble){
+  pattern_vec_t cur;
+  size_t i;
+  for(int l = 0; l < PATTERN_VEC_WORDS; l++){
+    cur[l] = base + l * step;
+  }
+  for(i = 0; i + PATTERN_VEC_WORDS <= size; i += PATTERN_VEC_WORDS){
+    pattern_vec_t exp = cur;
+    PATTERN_WORD(exp, hi, scramble);
+    memcpy(buf + i, & exp, sizeof(exp));
+    cur += PATTERN_VEC_WORDS * step;
+  }
+  for(; i < size; i++){
+    uint64_t exp = base + i * step;
+    PATTERN_WORD(exp, hi, scramble);
+    buf[i] = exp;
+  }
+}
+
+/*
+ * Compare the words against the pattern, if stamped the first word of
+ * each PATTERN_STAMP_WORDS is expected to be the stamp of the item instead.
+ * @return the index of the first mismatching word or size if all words match
+ */
+PATTERN_KERNEL static size_t verify_words(const uint64_t * buf, size_t size, uint64_t hi, uint64_t base, uint64_t step, int scramble, int stamped, uint64_t item, uint64_t stamp_hi){
+  for(size_t c = 0; c < size; c += PATTERN_STAMP_WORDS){
+    size_t n = size - c < PATTERN_STAMP_WORDS ? size - c : PATTERN_STAMP_WORDS;
+    pattern_vec_t diff = {0};
+    pattern_vec_t cur;
+    uint64_t d = 0;
+    size_t i = 0;
+    for(int l = 0; l < PATTERN_VEC_WORDS; l++){
+      cur[l] = base + (c + l) * step;
+    }
+    if(n >= PATTERN_VEC_WORDS){
+      pattern_vec_t v;
+      pattern_vec_t exp = cur;
+      PATTERN_WORD(exp, hi, scramble);
+      if(stamped){
+        exp[0] = pattern_stamp(item, c, stamp_hi);
+      }
+      memcpy(& v, buf + c, sizeof(v));
+      diff = v ^ exp;
+      cur += PATTERN_VEC_WORDS * step;
+      for(i = PATTERN_VEC_WORDS; i + PATTERN_VEC_WORDS <= n; i += PATTERN_VEC_WORDS){
+        memcpy(& v, buf + c + i, sizeof(v));
+        exp = cur;
+        PATTERN_WORD(exp, hi, scramble);
+        diff |= v ^ exp;
+        cur += PATTERN_VEC_WORDS * step;
+      }
+      for(int l = 0; l < PATTERN_VEC_WORDS; l++){
+        d |= diff[l];
+      }
+    }
+    for(; i < n; i++){
+      uint64_t exp = base + (c + i) * step;
+      PATTERN_WORD(exp, hi, scramble);
+      if(stamped && i == 0){
+        exp = pattern_stamp(item, c, stamp_hi);
+      }
+      d |= buf[c + i] ^ exp;
+    }
+    if(d == 0){
+      continue;
+    }
+    /* rarely needed: locate the first mismatch inside the chunk */
+    for(i = 0; i < n; i++){
+      uint64_t exp = base + (c + i) * step;
+      PATTERN_WORD(exp, hi, scramble);
+      if(stamped && i == 0){
+        exp = pattern_stamp(item, c, stamp_hi);
+      }
+      if(buf[c + i] != exp){
+        return c + i;
+      }
+    }
+  }
+  return size;
+}
+
+/*
+ * The scrambled patterns are keyed by seed and rank, the counter of word i is
+ * item / 8 + i. As IOR uses the file offset as item, the data at a file
+ * position does not depend on the transfer size.
+ */
+static inline uint64_t scramble_key(int rand_seed, int pretendRank){
+  return mix64(((uint64_t) (uint32_t) rand_seed << 32) | (uint32_t) pretendRank);
+}
+
+static inline uint64_t scramble_base(uint64_t item, int rand_seed, int pretendRank){
+  return scramble_key(rand_seed, pretendRank) + (item / sizeof(uint64_t)) * PATTERN_GAMMA;
+}
+
+/*
+ * DATA_DEDUPE consists of 4 KiB blocks, each starting with dedupe_random_words
+ * scrambled words followed by zeros to achieve the compression ratio.
+ * A block is a duplicate with probability dedupe_fraction, its content is then
+ * one of DEDUPE_POOL_BLOCKS blocks shared by all ranks, otherwise it is the
+ * scrambled data of its position.
+ */
+#define DEDUPE_BLOCK_WORDS PATTERN_STAMP_WORDS
+#define DEDUPE_POOL_BLOCKS 64
+
+static double dedupe_fraction = 0.0;
+static size_t dedupe_random_words = DEDUPE_BLOCK_WORDS;
+
+void set_dedupe_pattern(double compress, double fraction){
+  dedupe_fraction = fraction;
+  dedupe_random_words = (size_t) ceil(DEDUPE_BLOCK_WORDS / compress);
+}
+
+/* base of the counter sequence for the content of the block */
+static uint64_t dedupe_block_base(uint64_t block, uint64_t key, uint64_t pool_key){
+  uint64_t h = mix64(key + block * PATTERN_GAMMA);
+  if ((h >> 11) * 0x1.0p-53 < dedupe_fraction){
+    return pool_key + (h % DEDUPE_POOL_BLOCKS) * DEDUPE_BLOCK_WORDS * PATTERN_GAMMA;
+  }
+  return key + block * DEDUPE_BLOCK_WORDS * PATTERN_GAMMA;
+}
+
+/*
+ * Fill or verify (if verify is set) the words of a DATA_DEDUPE buffer.
+ * @return the index of the first mismatching word or size if all words match
+ */
+static size_t dedupe_words(uint64_t * buf, size_t size, uint64_t item, int rand_seed, int pretendRank, int verify){
+  uint64_t key = scramble_key(rand_seed, pretendRank);
+  uint64_t pool_key = mix64(~(uint64_t) (uint32_t) rand_seed);
+  uint64_t word = item / sizeof(uint64_t);
+  size_t i = 0;
+  while(i < size){
+    size_t pos = (word + i) % DEDUPE_BLOCK_WORDS;
+    size_t n = DEDUPE_BLOCK_WORDS - pos < size - i ? DEDUPE_BLOCK_WORDS - pos : size - i;
+    size_t r = pos < dedupe_random_words ? dedupe_random_words - pos : 0;
+    uint64_t base = dedupe_block_base((word + i) / DEDUPE_BLOCK_WORDS, key, pool_key) + pos * PATTERN_GAMMA;
+    if(r > n){
+      r = n;
+    }
+    if(verify){
+      size_t first = verify_words(buf + i, r, 0, base, PATTERN_GAMMA, 1, 0, 0, 0);
+      if(first == r){
+        first = r + verify_words(buf + i + r, n - r, 0, 0, 0, 0, 0, 0, 0);
+      }
+      if(first < n){
+        return i + first;
+      }
+    }else{
+      fill_words(buf + i, r, 0, base, PATTERN_GAMMA, 1);
+      memset(buf + i + r, 0, (n - r) * sizeof(uint64_t));
+    }
+    i += n;
+  }
+  return size;
+}
+
 /**
  * Modifies a buffer for a write.  Performance sensitive because it is called
  * before each write.
  *
+ * @param item byte position of the buffer in the data stream, e.g., the file offset
  * @param buf pointer to byte buffer to fill
  * @param bytes number of bytes to produce to fill buffer
  * @param rand_seed seed to use for PRNG
@@ -105,22 +322,20 @@ void update_write_memory_pattern(uint64_t item, char * buf, size_t bytes, int ra
   size_t size = bytes / sizeof(uint64_t);
   uint64_t * buffi = (uint64_t*) buf;
 
-  if (dataPacketType == DATA_RANDOM) {
-      uint64_t rand_state_local;
-      unsigned seed = rand_seed + pretendRank + item;
-      rand_state_local = rand_r(&seed);
-      for (size_t i = 0; i < size; i++) {
-          rand_state_local *= RANDALGO_GOLDEN_RATIO_PRIME;
-          rand_state_local >>= 3;
-          buffi[i] = rand_state_local;
-      }
+  if (dataPacketType == DATA_DEDUPE) {
+      dedupe_words(buffi, size, item, rand_seed, pretendRank, 0);
       return;
   }
+  if (dataPacketType == DATA_RANDOM || dataPacketType == DATA_INCOMPRESSIBLE) {
+      fill_words(buffi, size, 0, scramble_base(item, rand_seed, pretendRank), PATTERN_GAMMA, 1);
+      if (dataPacketType == DATA_RANDOM)
+        return;
+  }
 
   /* DATA_INCOMPRESSIBLE and DATA_OFFSET */
-  int k = 1;
-  for(size_t i=0; i < size; i+=512, k++){
-    buffi[i] = ((uint32_t) item * k) | ((uint64_t) pretendRank) << 32;
+  uint64_t stamp_hi = ((uint64_t) pretendRank) << 32;
+  for(size_t i=0; i < size; i+=PATTERN_STAMP_WORDS){
+    buffi[i] = pattern_stamp(item, i, stamp_hi);
   }
 }
 
@@ -142,28 +357,21 @@ void generate_memory_pattern(char * buf, size_t bytes, int rand_seed, int preten
   }
 #endif
   uint64_t * buffi = (uint64_t*) buf;
-  // first half of 64 bits use the rank
   const size_t size = bytes / 8;
   // the first 8 bytes of each 4k block are updated at runtime
-  for(size_t i=0; i < size; i++){
-    switch(dataPacketType){
-      case(DATA_RANDOM):
-        // Nothing to do, will work on updates
-        break;
-      case(DATA_INCOMPRESSIBLE):{
-        unsigned seed = rand_seed + pretendRank;
-        uint64_t hi = ((uint64_t) rand_r(& seed) << 32);
-        uint64_t lo = (uint64_t) rand_r(& seed);
-        buffi[i] = hi | lo;
-        break;
-      }case(DATA_OFFSET):{
-      }case(DATA_TIMESTAMP):{
-        buffi[i] = ((uint64_t) pretendRank) << 32 | rand_seed + i;
-        break;
-      }
-    }
+  switch(dataPacketType){
+    case(DATA_RANDOM):
+    case(DATA_INCOMPRESSIBLE):
+    case(DATA_DEDUPE):
+      // Nothing to do, will work on updates
+      break;
+    case(DATA_OFFSET):
+    case(DATA_TIMESTAMP):
+      // first half of 64 bits use the rank
+      fill_words(buffi, size, ((uint64_t) pretendRank) << 32, (uint64_t) rand_seed, 1, 0);
+      break;
   }
-  
+
   for(size_t i=size*8; i < bytes; i++){
     buf[i] = (char) i;
   }
@@ -179,60 +387,52 @@ void invalidate_buffer_pattern(char * buffer, size_t bytes, ior_memory_flags typ
   }
 }
 
-int verify_memory_pattern(uint64_t item, char * buffer, size_t bytes, int rand_seed, int pretendRank, ior_dataPacketType_e dataPacketType, ior_memory_flags type){  
-  int error = 0;
+int verify_memory_pattern(uint64_t item, char * buffer, size_t bytes, int rand_seed, int pretendRank, ior_dataPacketType_e dataPacketType, ior_memory_flags type){
 #ifdef HAVE_GPU_DIRECT
   if(type == IOR_MEMORY_TYPE_GPU_DEVICE_ONLY || type == IOR_MEMORY_TYPE_GPU_MANAGED_CHECK_GPU){
-    error = verify_memory_pattern_gpu(item, buffer, bytes, rand_seed, pretendRank, dataPacketType);
-    return error;
+    return verify_memory_pattern_gpu(item, buffer, bytes, rand_seed, pretendRank, dataPacketType);
   }
 #endif
-  // always read all data to ensure that performance numbers stay the same
   uint64_t * buffi = (uint64_t*) buffer;
-    
-  // the first 8 bytes are set to item number
-  int k=1;  
-  
-  uint64_t rand_state_local;
-  unsigned seed = rand_seed + pretendRank + item;
-  rand_state_local = rand_r(&seed);
+  uint64_t stamp_hi = ((uint64_t) pretendRank) << 32;
   const size_t size = bytes / 8;
-  for(size_t i=0; i < size; i++){
-    uint64_t exp;
-        
-    switch(dataPacketType){
-      case(DATA_RANDOM):
-        rand_state_local *= RANDALGO_GOLDEN_RATIO_PRIME;
-        rand_state_local >>= 3;
-        exp = rand_state_local;
-        break;
-      case(DATA_INCOMPRESSIBLE):{
-        unsigned seed = rand_seed + pretendRank;
-        uint64_t hi = ((uint64_t) rand_r(& seed) << 32);
-        uint64_t lo = (uint64_t) rand_r(& seed);
-        exp = hi | lo;
-        break;
-      }case(DATA_OFFSET):{
-      }case(DATA_TIMESTAMP):{
-        exp = ((uint64_t) pretendRank) << 32 | rand_seed + i;
+  size_t first = size;
+
+  switch(dataPacketType){
+    case(DATA_RANDOM):
+      first = verify_words(buffi, size, 0, scramble_base(item, rand_seed, pretendRank), PATTERN_GAMMA, 1, 0, item, stamp_hi);
+      break;
+    case(DATA_INCOMPRESSIBLE):
+      // the first 8 bytes of each 4k block are set to the item number
+      first = verify_words(buffi, size, 0, scramble_base(item, rand_seed, pretendRank), PATTERN_GAMMA, 1, 1, item, stamp_hi);
+      break;
+    case(DATA_OFFSET):
+      first = verify_words(buffi, size, stamp_hi, (uint64_t) rand_seed, 1, 0, 1, item, stamp_hi);
+      break;
+    case(DATA_TIMESTAMP):
+      first = verify_words(buffi, size, stamp_hi, (uint64_t) rand_seed, 1, 0, 0, item, stamp_hi);
+      break;
+    case(DATA_DEDUPE):
+      first = dedupe_words(buffi, size, item, rand_seed, pretendRank, 1);
+      break;
+  }
+  size_t first_byte = first * 8;
+  if(first == size){
+    first_byte = bytes;
+    for(size_t i=size*8; i < bytes; i++){
+      if(buffer[i] != (char) i){
+        first_byte = i;
         break;
       }
     }
-    if(i % 512 == 0 && (dataPacketType != DATA_TIMESTAMP) && dataPacketType != DATA_RANDOM){
-      exp = ((uint32_t) item * k) | ((uint64_t) pretendRank) << 32;
-      k++;
-    }
-    if(buffi[i] != exp){
-      error = 1;
-    }
   }
-  for(size_t i=size*8; i < bytes; i++){
-    if(buffer[i] != (char) i){
-      error = 1;
-    }
+  if(first_byte == bytes){
+    return 0;
   }
-  
-  return error;
+  if(verbose >= VERBOSE_3){
+    fprintf(out_logfile, "[%d] Data mismatch for item %llu at byte %zu of %zu\n", rank, (unsigned long long) item, first_byte, bytes);
+  }
+  return 1;
 }
 
 /* Data structure to store information about per-operation timer */
@@ -305,6 +505,324 @@ void OpTimerFree(OpTimer** otp){
   *otp = NULL;
 }
 
+/*
+ * The runtime is stored in ns, values below 2^LATENCY_SUB_BITS get a bucket
+ * each, above, every power of two is split into 2^(LATENCY_SUB_BITS - 1)
+ * linear buckets. Values beyond 2^LATENCY_MAX_BITS ns (4.9 hours) are
+ * accounted in the last bucket.
+ */
+#define LATENCY_SUB_BITS 8
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS 44
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS + (LATENCY_MAX_BITS - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS / 2)
+
+/* consists of uint64_t only to allow the reduction as a contiguous datatype */
+struct LatencyHistogram{
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[LATENCY_BUCKETS];
+};
+
+static int LatencyBucket(uint64_t value){
+  if(value < LATENCY_SUB_BUCKETS){
+    return (int) value;
+  }
+  if(value >= (1ull << LATENCY_MAX_BITS)){
+    value = (1ull << LATENCY_MAX_BITS) - 1;
+  }
+  int shift = 1;
+  while(value >> (shift + LATENCY_SUB_BITS)){
+    shift++;
+  }
+  return LATENCY_SUB_BUCKETS + (shift - 1) * LATENCY_SUB_BUCKETS / 2 + (int)(value >> shift) - LATENCY_SUB_BUCKETS / 2;
+}
+
+/* the largest value accounted in the bucket */
+static uint64_t LatencyBucketValue(int bucket){
+  if(bucket < LATENCY_SUB_BUCKETS){
+    return bucket;
+  }
+  bucket -= LATENCY_SUB_BUCKETS;
+  int shift = bucket / (LATENCY_SUB_BUCKETS / 2) + 1;
+  uint64_t mantissa = bucket % (LATENCY_SUB_BUCKETS / 2) + LATENCY_SUB_BUCKETS / 2;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+LatencyHistogram* LatencyHistogramInit(void){
+  LatencyHistogram * h = safeMalloc(sizeof(LatencyHistogram));
+  h->min = UINT64_MAX;
+  return h;
+}
+
+void LatencyHistogramValue(LatencyHistogram* h, double runTime){
+  if(h == NULL) {
+    return;
+  }
+  uint64_t ns = runTime > 0 ? (uint64_t)(runTime * 1e9 + 0.5) : 0;
+  h->buckets[LatencyBucket(ns)]++;
+  h->count++;
+  if(ns < h->min) h->min = ns;
+  if(ns > h->max) h->max = ns;
+}
+
+void LatencyHistogramMerge(LatencyHistogram* h, const LatencyHistogram* other){
+  for(int i=0; i < LATENCY_BUCKETS; i++){
+    h->buckets[i] += other->buckets[i];
+  }
+  h->count += other->count;
+  if(other->min < h->min) h->min = other->min;
+  if(other->max > h->max) h->max = other->max;
+}
+
+static void LatencyHistogramReduceOp(void * in, void * inout, int * len, MPI_Datatype * type){
+  LatencyHistogram * src = (LatencyHistogram*) in;
+  LatencyHistogram * dst = (LatencyHistogram*) inout;
+  for(int i=0; i < *len; i++){
+    LatencyHistogramMerge(& dst[i], & src[i]);
+  }
+}
+
+LatencyHistogram* LatencyHistogramReduce(const LatencyHistogram* h, int root, MPI_Comm com){
+  MPI_Datatype type;
+  MPI_Op op;
+  int my_rank;
+  LatencyHistogram * result = NULL;
+
+  MPI_CHECK(MPI_Comm_rank(com, & my_rank), "cannot get rank");
+  if(my_rank == root){
+    result = LatencyHistogramInit();
+  }
+  MPI_CHECK(MPI_Type_contiguous(sizeof(LatencyHistogram) / sizeof(uint64_t), MPI_UINT64_T, & type), "cannot create histogram datatype");
+  MPI_CHECK(MPI_Type_commit(& type), "cannot commit histogram datatype");
+  MPI_CHECK(MPI_Op_create(LatencyHistogramReduceOp, 1, & op), "cannot create histogram reduction");
+  MPI_CHECK(MPI_Reduce(h, result, 1, type, op, root, com), "cannot reduce histogram");
+  MPI_CHECK(MPI_Op_free(& op), "cannot free histogram reduction");
+  MPI_CHECK(MPI_Type_free(& type), "cannot free histogram datatype");
+  return result;
+}
+
+double LatencyHistogramPercentile(const LatencyHistogram* h, double fraction){
+  if(h->count == 0){
+    return 0;
+  }
+  if(fraction >= 1.0){
+    return h->max * 1e-9;
+  }
+  uint64_t target = (uint64_t) ceil(fraction * h->count);
+  if(target == 0){
+    target = 1;
+  }
+  uint64_t seen = 0;
+  for(int i=0; i < LATENCY_BUCKETS; i++){
+    seen += h->buckets[i];
+    if(seen >= target){
+      uint64_t value = LatencyBucketValue(i);
+      if(value > h->max) value = h->max;
+      if(value < h->min) value = h->min;
+      return value * 1e-9;
+    }
+  }
+  return h->max * 1e-9;
+}
+
+uint64_t LatencyHistogramCount(const LatencyHistogram* h){
+  return h->count;
+}
+
+void LatencyHistogramFree(LatencyHistogram** hp){
+  if(hp == NULL || *hp == NULL) {
+    return;
+  }
+  free(*hp);
+  *hp = NULL;
+}
+
+struct IntervalSamples{
+    double origin;
+    double interval;
+    double end;    /* time of the last value */
+    int count;
+    int size;
+    uint64_t * bytes;
+    uint64_t * ops;
+};
+
+IntervalSamples* IntervalSamplesInit(double origin, double interval){
+  IntervalSamples * s = safeMalloc(sizeof(IntervalSamples));
+  s->origin = origin;
+  s->interval = interval;
+  s->end = origin;
+  return s;
+}
+
+static void IntervalSamplesResize(IntervalSamples* s, int count){
+  if(count > s->size){
+    int size = s->size == 0 ? 64 : s->size;
+    while(size < count){
+      size *= 2;
+    }
+    s->bytes = realloc(s->bytes, sizeof(uint64_t) * size);
+    s->ops = realloc(s->ops, sizeof(uint64_t) * size);
+    if(s->bytes == NULL || s->ops == NULL){
+      ERR("Could not allocate interval samples");
+    }
+    s->size = size;
+  }
+  for(int i = s->count; i < count; i++){
+    s->bytes[i] = 0;
+    s->ops[i] = 0;
+  }
+  if(count > s->count){
+    s->count = count;
+  }
+}
+
+void IntervalSamplesValue(IntervalSamples* s, double time, uint64_t bytes){
+  if(s == NULL) {
+    return;
+  }
+  int i = time > s->origin ? (int)((time - s->origin) / s->interval) : 0;
+  IntervalSamplesResize(s, i + 1);
+  s->bytes[i] += bytes;
+  s->ops[i]++;
+  if(time > s->end) s->end = time;
+}
+
+void IntervalSamplesMerge(IntervalSamples* s, const IntervalSamples* other){
+  IntervalSamplesResize(s, other->count);
+  for(int i=0; i < other->count; i++){
+    s->bytes[i] += other->bytes[i];
+    s->ops[i] += other->ops[i];
+  }
+  if(other->end > s->end) s->end = other->end;
+}
+
+IntervalSamples* IntervalSamplesReduce(const IntervalSamples* s, int root, MPI_Comm com){
+  int my_rank;
+  double end;
+  IntervalSamples * result = NULL;
+
+  MPI_CHECK(MPI_Comm_rank(com, & my_rank), "cannot get rank");
+  MPI_CHECK(MPI_Allreduce(& s->end, & end, 1, MPI_DOUBLE, MPI_MAX, com), "cannot reduce end of samples");
+  int count = (int)((end - s->origin) / s->interval) + 1;
+  /* bytes followed by ops */
+  uint64_t * local = safeMalloc(sizeof(uint64_t) * 2 * count);
+  for(int i=0; i < s->count; i++){
+    local[i] = s->bytes[i];
+    local[count + i] = s->ops[i];
+  }
+  uint64_t * global = NULL;
+  if(my_rank == root){
+    global = safeMalloc(sizeof(uint64_t) * 2 * count);
+  }
+  MPI_CHECK(MPI_Reduce(local, global, 2 * count, MPI_UINT64_T, MPI_SUM, root, com), "cannot reduce samples");
+  if(my_rank == root){
+    result = IntervalSamplesInit(s->origin, s->interval);
+    IntervalSamplesResize(result, count);
+    for(int i=0; i < count; i++){
+      result->bytes[i] = global[i];
+      result->ops[i] = global[count + i];
+    }
+    result->end = end;
+    free(global);
+  }
+  free(local);
+  return result;
+}
+
+int IntervalSamplesCount(const IntervalSamples* s){
+  return s->count;
+}
+
+void IntervalSamplesGet(const IntervalSamples* s, int i, double * start, double * duration, uint64_t * bytes, uint64_t * ops){
+  *start = i * s->interval;
+  *duration = s->interval;
+  if(i == s->count - 1 && s->end - s->origin - *start > 0){
+    *duration = s->end - s->origin - *start;
+  }
+  *bytes = s->bytes[i];
+  *ops = s->ops[i];
+}
+
+void IntervalSamplesFree(IntervalSamples** sp){
+  if(sp == NULL || *sp == NULL) {
+    return;
+  }
+  free((*sp)->bytes);
+  free((*sp)->ops);
+  free(*sp);
+  *sp = NULL;
+}
+
+#define UNIQUE_REGISTER_BITS 12
+#define UNIQUE_REGISTERS (1 << UNIQUE_REGISTER_BITS)
+
+struct UniqueCounter{
+    uint8_t registers[UNIQUE_REGISTERS];
+};
+
+UniqueCounter* UniqueCounterInit(void){
+  return safeMalloc(sizeof(UniqueCounter));
+}
+
+void UniqueCounterValue(UniqueCounter* c, uint64_t item){
+  if(c == NULL) {
+    return;
+  }
+  uint64_t hash = mix64(item + PATTERN_GAMMA);
+  int reg = (int)(hash >> (64 - UNIQUE_REGISTER_BITS));
+  /* position of the first set bit of the remaining bits */
+  uint8_t rho = __builtin_clzll((hash << UNIQUE_REGISTER_BITS) | (1ull << (UNIQUE_REGISTER_BITS - 1))) + 1;
+  if(rho > c->registers[reg]){
+    c->registers[reg] = rho;
+  }
+}
+
+void UniqueCounterMerge(UniqueCounter* c, const UniqueCounter* other){
+  for(int i=0; i < UNIQUE_REGISTERS; i++){
+    if(other->registers[i] > c->registers[i]){
+      c->registers[i] = other->registers[i];
+    }
+  }
+}
+
+UniqueCounter* UniqueCounterReduce(const UniqueCounter* c, int root, MPI_Comm com){
+  int my_rank;
+  UniqueCounter * result = NULL;
+
+  MPI_CHECK(MPI_Comm_rank(com, & my_rank), "cannot get rank");
+  if(my_rank == root){
+    result = UniqueCounterInit();
+  }
+  MPI_CHECK(MPI_Reduce(c->registers, result ? result->registers : NULL, UNIQUE_REGISTERS, MPI_UNSIGNED_CHAR, MPI_MAX, root, com), "cannot reduce unique counter");
+  return result;
+}
+
+double UniqueCounterEstimate(const UniqueCounter* c){
+  double m = UNIQUE_REGISTERS;
+  double sum = 0;
+  int zeros = 0;
+  for(int i=0; i < UNIQUE_REGISTERS; i++){
+    sum += ldexp(1.0, -c->registers[i]);
+    zeros += c->registers[i] == 0;
+  }
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  if(estimate <= 2.5 * m && zeros > 0){
+    /* linear counting is more accurate for small counts */
+    estimate = m * log(m / zeros);
+  }
+  return estimate;
+}
+
+void UniqueCounterFree(UniqueCounter** cp){
+  if(cp == NULL || *cp == NULL) {
+    return;
+  }
+  free(*cp);
+  *cp = NULL;
+}
+
 void* safeMalloc(uint64_t size){
   void * d = malloc(size);
   if (d == NULL){
@@ -358,8 +876,12 @@ size_t NodeMemoryStringToBytes(char *size_str)
         return mem / 100 * percent;
 }
 
-ior_dataPacketType_e parsePacketType(char t){
-    switch(t) {
+/*
+ * Parse the packet type, only the first character matters.
+ * The dedupe type accepts ratios, e.g., dedupe:compress=2.0:dedupe=0.3
+ */
+ior_dataPacketType_e parsePacketType(const char * type, double * dedupeCompress, double * dedupeFraction){
+    switch(type[0]) {
     case '\0': return DATA_TIMESTAMP;
     case 'i': /* Incompressible */
             return DATA_INCOMPRESSIBLE;
@@ -369,8 +891,32 @@ ior_dataPacketType_e parsePacketType(char t){
             return DATA_OFFSET;
     case 'r': /* randomized blocks */
             return DATA_RANDOM;
-    default:
-      ERRF("Unknown packet type \"%c\"; generic assumed\n", t);
+    case 'd':{ /* dedupe and compression ratios */
+            const char * arg = strchr(type, ':');
+            while(arg != NULL){
+              double value;
+              char key[10];
+              if(sscanf(arg, ":%9[^=:]=%lf", key, & value) != 2){
+                ERRF("Cannot parse the packet type \"%s\"", type);
+              }
+              if(strcmp(key, "compress") == 0){
+                if(value < 1.0){
+                  ERR("The compression ratio must be at least 1");
+                }
+                *dedupeCompress = value;
+              }else if(strcmp(key, "dedupe") == 0){
+                if(value < 0.0 || value > 1.0){
+                  ERR("The dedupe fraction must be between 0 and 1");
+                }
+                *dedupeFraction = value;
+              }else{
+                ERRF("Unknown ratio \"%s\" for the dedupe packet type", key);
+              }
+              arg = strchr(arg + 1, ':');
+            }
+            return DATA_DEDUPE;
+    }default:
+      ERRF("Unknown packet type \"%c\"; generic assumed\n", type[0]);
       return DATA_OFFSET;
     }
 }
@@ -381,7 +927,7 @@ void updateParsedOptions(IOR_param_t * options, options_all_t * global_options){
     }
 
     if (options->buffer_type && options->buffer_type[0] != 0){
-      options->dataPacketType = parsePacketType(options->buffer_type[0]);
+      options->dataPacketType = parsePacketType(options->buffer_type, & options->dedupeCompress, & options->dedupeFraction);
     }
     if (options->memoryPerNodeStr){
       options->memoryPerNode = NodeMemoryStringToBytes(options->memoryPerNodeStr);
@@ -940,52 +1486,168 @@ int uname(struct utsname *name)
 #endif /* _WIN32 */
 
 /*
- * Get time stamp.  Use MPI_Timer() unless _NO_MPI_TIMER is defined,
- * in which case use gettimeofday().
+ * Time stamps are taken from a monotonic clock that is not subject to NTP
+ * adjustments, or from the time stamp counter calibrated against it.
+ * init_clock() estimates the offset of every process to the clock of rank 0,
+ * GetTimeStamp() applies it, so time stamps are comparable across processes.
  */
-double GetTimeStamp(void)
+static double clock_offset = 0;
+static double clock_max_offset = 0;
+static double clock_error = 0;
+
+#ifdef HAVE_TSC_TIMER
+static int tsc_enabled = 0;
+static double tsc_base_time;
+static uint64_t tsc_base;
+static double tsc_hz;
+#endif
+
+static double RawTimeStamp(void)
 {
-        double timeVal;
+#ifdef HAVE_TSC_TIMER
+        if (tsc_enabled)
+                return tsc_base_time + (double)(__rdtsc() - tsc_base) / tsc_hz;
+#endif
+#if defined(CLOCK_MONOTONIC_RAW) || defined(CLOCK_MONOTONIC)
+        struct timespec timer;
+#  ifdef CLOCK_MONOTONIC_RAW
+        if (clock_gettime(CLOCK_MONOTONIC_RAW, &timer) != 0)
+#  else
+        if (clock_gettime(CLOCK_MONOTONIC, &timer) != 0)
+#  endif
+                ERR("cannot use clock_gettime()");
+        return (double)timer.tv_sec + ((double)timer.tv_nsec / 1000000000);
+#else
         struct timeval timer;
 
         if (gettimeofday(&timer, (struct timezone *)NULL) != 0)
                 ERR("cannot use gettimeofday()");
-        timeVal = (double)timer.tv_sec + ((double)timer.tv_usec / 1000000);
+        return (double)timer.tv_sec + ((double)timer.tv_usec / 1000000);
+#endif
+}
 
-        return (timeVal);
+/*
+ * Get time stamp in seconds on the common timebase of all processes.
+ */
+double GetTimeStamp(void)
+{
+        return RawTimeStamp() + clock_offset;
 }
 
+#ifdef HAVE_TSC_TIMER
 /*
- * Determine any spread (range) between node times.
- * Obsolete
+ * Use the time stamp counter if it is invariant, i.e., ticks at a constant
+ * rate in all power states.  The rate is measured against the monotonic
+ * clock over 100 ms, the relative error is in the order of 1e-6.
  */
-static double TimeDeviation(MPI_Comm com)
+static void InitTSC(void)
 {
-        double timestamp;
-        double min = 0;
-        double max = 0;
-        double roottimestamp;
+        unsigned int eax, ebx, ecx, edx;
+
+        if (tsc_enabled)
+                return;
+        if (! __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || ! (edx & (1 << 8))) {
+                if (rank == 0)
+                        WARN("The CPU has no invariant TSC, using the monotonic clock");
+                return;
+        }
+        double start = RawTimeStamp();
+        uint64_t tsc_start = __rdtsc();
+        double end;
+        do {
+                end = RawTimeStamp();
+        } while (end - start < 0.1);
+        uint64_t tsc_end = __rdtsc();
+        tsc_hz = (double)(tsc_end - tsc_start) / (end - start);
+        tsc_base_time = end;
+        tsc_base = tsc_end;
+        tsc_enabled = 1;
+}
+#endif
 
-        MPI_CHECK(MPI_Barrier(com), "barrier error");
-        timestamp = GetTimeStamp();
-        MPI_CHECK(MPI_Reduce(&timestamp, &min, 1, MPI_DOUBLE,
-                             MPI_MIN, 0, com),
-                  "cannot reduce tasks' times");
-        MPI_CHECK(MPI_Reduce(&timestamp, &max, 1, MPI_DOUBLE,
-                             MPI_MAX, 0, com),
-                  "cannot reduce tasks' times");
+/* rounds of the ping-pong with each process, the one with the lowest round trip time is used */
+#define CLOCK_PINGPONG_ROUNDS 10
 
-        /* delta between individual nodes' time and root node's time */
-        roottimestamp = timestamp;
-        MPI_CHECK(MPI_Bcast(&roottimestamp, 1, MPI_DOUBLE, 0, com),
-                  "cannot broadcast root's time");
-        // wall_clock_delta = timestamp - roottimestamp;
+/*
+ * Estimate the offset of the clock of each process to the clock of rank 0.
+ * A process sends a message at t1 to a synchronized process, which replies
+ * with its time t0, the reply arrives at t2.  Assuming symmetric latencies,
+ * the synchronized clock reads t0 at the local time (t1 + t2) / 2 with an
+ * error below (t2 - t1) / 2.  The processes are synchronized along a binomial
+ * tree rooted at rank 0, i.e., in log2(size) steps, the errors add up along
+ * the path to rank 0.
+ */
+void init_clock(MPI_Comm com){
+        int my_rank, size;
+        double offset = 0;
+        double error = 0;
+        double value;
+        MPI_Status status;
+
+        MPI_CHECK(MPI_Comm_rank(com, &my_rank), "cannot get rank");
+        MPI_CHECK(MPI_Comm_size(com, &size), "cannot get size");
+#ifdef HAVE_TSC_TIMER
+        if (timerTSC)
+                InitTSC();
+#else
+        if (timerTSC && rank == 0)
+                WARN("The TSC timer is not supported on this platform, using the monotonic clock");
+#endif
+        MPI_CHECK(MPI_Barrier(com), "barrier error");
+        int step = 1;
+        while (step * 2 < size)
+                step *= 2;
+        for ( ; step > 0; step /= 2) {
+                if (my_rank % (2 * step) == 0 && my_rank + step < size) {
+                        /* synchronized, serve the process step ranks away */
+                        int peer = my_rank + step;
+                        for (int i = 0; i < CLOCK_PINGPONG_ROUNDS; i++) {
+                                MPI_CHECK(MPI_Recv(&value, 1, MPI_DOUBLE, peer, 0, com, &status), "cannot receive clock request");
+                                value = RawTimeStamp() + offset;
+                                MPI_CHECK(MPI_Send(&value, 1, MPI_DOUBLE, peer, 0, com), "cannot send clock");
+                        }
+                        MPI_CHECK(MPI_Send(&error, 1, MPI_DOUBLE, peer, 0, com), "cannot send clock error");
+                } else if (my_rank % (2 * step) == step) {
+                        int peer = my_rank - step;
+                        double min_rtt = INFINITY;
+                        for (int i = 0; i < CLOCK_PINGPONG_ROUNDS; i++) {
+                                double t1 = RawTimeStamp();
+                                MPI_CHECK(MPI_Send(&t1, 1, MPI_DOUBLE, peer, 0, com), "cannot send clock request");
+                                MPI_CHECK(MPI_Recv(&value, 1, MPI_DOUBLE, peer, 0, com, &status), "cannot receive clock");
+                                double t2 = RawTimeStamp();
+                                if (t2 - t1 < min_rtt) {
+                                        min_rtt = t2 - t1;
+                                        offset = value - (t1 + t2) / 2;
+                                }
+                        }
+                        MPI_CHECK(MPI_Recv(&error, 1, MPI_DOUBLE, peer, 0, com, &status), "cannot receive clock error");
+                        error += min_rtt / 2;
+                }
+        }
+        clock_offset = offset;
 
-        return max - min;
+        double abs_offset = fabs(offset);
+        MPI_CHECK(MPI_Allreduce(&abs_offset, &clock_max_offset, 1, MPI_DOUBLE, MPI_MAX, com), "cannot reduce clock offset");
+        MPI_CHECK(MPI_Allreduce(&error, &clock_error, 1, MPI_DOUBLE, MPI_MAX, com), "cannot reduce clock error");
 }
 
-void init_clock(MPI_Comm com){
+void GetClockOffset(double * max_offset, double * error){
+        *max_offset = clock_max_offset;
+        *error = clock_error;
+}
 
+char * GetClockSource(void){
+#ifdef HAVE_TSC_TIMER
+        if (tsc_enabled)
+                return "TSC";
+#endif
+#if defined(CLOCK_MONOTONIC_RAW)
+        return "CLOCK_MONOTONIC_RAW";
+#elif defined(CLOCK_MONOTONIC)
+        return "CLOCK_MONOTONIC";
+#else
+        return "gettimeofday";
+#endif
 }
 
 char * PrintTimestamp() {
@@ -1183,6 +1845,365 @@ void *aligned_buffer_alloc(size_t size, ior_memory_flags type)
   return (void *)aligned;
 }
 
+#define PERMUTATION_ROUNDS 6
+
+void random_permutation_init(random_permutation_t * perm, uint64_t count, uint64_t seed){
+  int bits = 0;
+  while(bits < 63 && (1ULL << bits) < count){
+    bits++;
+  }
+  perm->count = count;
+  perm->key = mix64(seed + 0x9e3779b97f4a7c15ULL);
+  perm->half_bits = bits > 1 ? (bits + 1) / 2 : 1;
+  perm->half_mask = (1ULL << perm->half_bits) - 1;
+}
+
+/*
+ * The Feistel network permutes [0, 4^half_bits) which is less than 4 * count,
+ * results outside of [0, count) are permuted again until they are in range.
+ */
+uint64_t random_permutation_get(const random_permutation_t * perm, uint64_t index){
+  uint64_t x = index;
+  do{
+    uint64_t left = x >> perm->half_bits;
+    uint64_t right = x & perm->half_mask;
+    for(int round = 0; round < PERMUTATION_ROUNDS; round++){
+      uint64_t tmp = left ^ (mix64(right ^ (perm->key + round)) & perm->half_mask);
+      left = right;
+      right = tmp;
+    }
+    x = (left << perm->half_bits) | right;
+  }while(x >= perm->count);
+  return x;
+}
+
+#define PARETO_DEFAULT_FRACTION 0.2  /* 80% of the accesses to 20% of the data */
+
+int skewed_distribution_parse(skewed_distribution_t * dist, const char * str){
+  memset(dist, 0, sizeof(skewed_distribution_t));
+  if(strcasecmp(str, "uniform") == 0){
+    dist->type = DISTRIBUTION_UNIFORM;
+  }else if(strncasecmp(str, "zipf:", 5) == 0){
+    dist->type = DISTRIBUTION_ZIPF;
+    if(sscanf(str + 5, "%lf", & dist->param[0]) != 1 || dist->param[0] <= 0){
+      return -1;
+    }
+  }else if(strncasecmp(str, "hotspot:", 8) == 0){
+    dist->type = DISTRIBUTION_HOTSPOT;
+    if(sscanf(str + 8, "%lf/%lf", & dist->param[0], & dist->param[1]) != 2
+       || dist->param[0] <= 0 || dist->param[0] > 100 || dist->param[1] < 0 || dist->param[1] > 100){
+      return -1;
+    }
+  }else if(strcasecmp(str, "pareto") == 0){
+    dist->type = DISTRIBUTION_PARETO;
+    dist->param[0] = PARETO_DEFAULT_FRACTION;
+  }else if(strncasecmp(str, "pareto:", 7) == 0){
+    dist->type = DISTRIBUTION_PARETO;
+    if(sscanf(str + 7, "%lf", & dist->param[0]) != 1 || dist->param[0] <= 0 || dist->param[0] >= 1){
+      return -1;
+    }
+  }else{
+    return -1;
+  }
+  return 0;
+}
+
+/* helpers of the Zipf sampler that are accurate for x close to 0 */
+static double zipf_helper1(double x){
+  return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+static double zipf_helper2(double x){
+  return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+}
+
+static double zipf_h(double exponent, double x){
+  return exp(-exponent * log(x));
+}
+
+static double zipf_h_integral(double exponent, double x){
+  double log_x = log(x);
+  return zipf_helper2((1 - exponent) * log_x) * log_x;
+}
+
+static double zipf_h_integral_inverse(double exponent, double x){
+  double t = x * (1 - exponent);
+  if(t < -1){
+    t = -1;
+  }
+  return exp(zipf_helper1(t) * x);
+}
+
+void skewed_distribution_init(skewed_distribution_t * dist, uint64_t count, uint64_t seed){
+  double exponent = dist->param[0];
+  dist->count = count;
+  dist->key = mix64(seed + 0x2545f4914f6cdd1dULL);
+  if(dist->type == DISTRIBUTION_ZIPF){
+    dist->h_integral_x1 = zipf_h_integral(exponent, 1.5) - 1;
+    dist->h_integral_n = zipf_h_integral(exponent, count + 0.5);
+    dist->s = 2 - zipf_h_integral_inverse(exponent, zipf_h_integral(exponent, 2.5) - zipf_h(exponent, 2));
+  }
+}
+
+/* the round-th uniform number in [0, 1) of draw index */
+static double skewed_distribution_uniform(const skewed_distribution_t * dist, uint64_t index, int round){
+  uint64_t x = mix64(mix64(index ^ dist->key) + round * PATTERN_GAMMA);
+  return (x >> 11) * 0x1.0p-53;
+}
+
+/*
+ * Zipf uses the rejection-inversion method of Hoermann and Derflinger which
+ * needs constant time and memory independent of count.
+ */
+uint64_t skewed_distribution_get(const skewed_distribution_t * dist, uint64_t index){
+  double u = skewed_distribution_uniform(dist, index, 0);
+  uint64_t rank;
+
+  switch(dist->type){
+  case DISTRIBUTION_ZIPF:{
+    double exponent = dist->param[0];
+    for(int round = 1; ; round++){
+      double h = dist->h_integral_n + u * (dist->h_integral_x1 - dist->h_integral_n);
+      double x = zipf_h_integral_inverse(exponent, h);
+      double k = floor(x + 0.5);
+      if(k < 1){
+        k = 1;
+      }else if(k > dist->count){
+        k = dist->count;
+      }
+      if(k - x <= dist->s || h >= zipf_h_integral(exponent, k + 0.5) - zipf_h(exponent, k)){
+        return (uint64_t) k - 1;
+      }
+      u = skewed_distribution_uniform(dist, index, round);
+    }
+  }
+  case DISTRIBUTION_HOTSPOT:{
+    uint64_t hot = (uint64_t) ceil(dist->count * dist->param[0] / 100);
+    double v = skewed_distribution_uniform(dist, index, 1);
+    if(hot > dist->count){
+      hot = dist->count;
+    }
+    if(u * 100 < dist->param[1] || hot == dist->count){
+      rank = (uint64_t)(v * hot);
+    }else{
+      rank = hot + (uint64_t)(v * (dist->count - hot));
+    }
+    break;
+  }
+  case DISTRIBUTION_PARETO:{
+    /* the fraction h of the ranks receives the fraction 1 - h of the draws */
+    double h = dist->param[0];
+    rank = (uint64_t)(dist->count * pow(u, log(h) / log(1 - h)));
+    break;
+  }
+  default:
+    rank = (uint64_t)(u * dist->count);
+  }
+  return rank < dist->count ? rank : dist->count - 1;
+}
+
+int size_distribution_parse(size_distribution_t * dist, const char * str){
+  char * copy = strdup(str);
+  char * saveptr = NULL;
+  char * dash = strchr(copy, '-');
+  int ret = 0;
+
+  memset(dist, 0, sizeof(size_distribution_t));
+  if(dash){
+    *dash = 0;
+    int64_t min = string_to_bytes(copy);
+    int64_t max = string_to_bytes(dash + 1);
+    if(min <= 0 || max < min || max % min != 0){
+      ret = -1;
+    }
+    dist->min = min;
+    dist->max = max;
+    free(copy);
+    return ret;
+  }
+  double total = 0;
+  for(char * item = strtok_r(copy, "+", & saveptr); item; item = strtok_r(NULL, "+", & saveptr)){
+    char * colon = strchr(item, ':');
+    double weight = 1;
+    if(dist->count == SIZE_DISTRIBUTION_MAX){
+      ret = -1;
+      break;
+    }
+    if(colon){
+      *colon = 0;
+      if(sscanf(colon + 1, "%lf", & weight) != 1 || weight <= 0){
+        ret = -1;
+        break;
+      }
+    }
+    int64_t size = string_to_bytes(item);
+    if(size <= 0){
+      ret = -1;
+      break;
+    }
+    total += weight;
+    dist->size[dist->count] = size;
+    dist->weight[dist->count] = total;
+    dist->count++;
+  }
+  free(copy);
+  if(ret != 0 || dist->count == 0){
+    return -1;
+  }
+  dist->min = dist->max = dist->size[0];
+  for(int i = 0; i < dist->count; i++){
+    dist->weight[i] /= total;
+    if(dist->size[i] < dist->min)
+      dist->min = dist->size[i];
+    if(dist->size[i] > dist->max)
+      dist->max = dist->size[i];
+  }
+  for(int i = 0; i < dist->count; i++){
+    if(dist->size[i] % dist->min != 0){
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*
+ * A range draws the size log-uniformly from [min, max + min) and rounds it
+ * down to a multiple of min, thus small and large sizes are equally likely
+ * per order of magnitude.
+ */
+uint64_t size_distribution_get(const size_distribution_t * dist, double u){
+  if(dist->count == 0){
+    double size = dist->min * exp(u * log((double)(dist->max + dist->min) / dist->min));
+    uint64_t multiple = (uint64_t)(size / dist->min) * dist->min;
+    if(multiple > dist->max)
+      return dist->max;
+    return multiple < dist->min ? dist->min : multiple;
+  }
+  for(int i = 0; i < dist->count - 1; i++){
+    if(u < dist->weight[i]){
+      return dist->size[i];
+    }
+  }
+  return dist->size[dist->count - 1];
+}
+
+/* Parses the extents of all dimensions separated by x, returns 0 on success */
+static int array_layout_parse_extents(uint64_t * extents, int ndims, char * str){
+  char * saveptr = NULL;
+  int count = 0;
+
+  for(char * item = strtok_r(str, "x", & saveptr); item; item = strtok_r(NULL, "x", & saveptr)){
+    char * end;
+    if(count == ndims){
+      return -1;
+    }
+    extents[count] = strtoull(item, & end, 10);
+    if(*end != 0 || extents[count] == 0){
+      return -1;
+    }
+    count++;
+  }
+  return count == ndims ? 0 : -1;
+}
+
+int array_layout_parse(array_layout_t * layout, const char * str){
+  char * copy = strdup(str);
+  char * saveptr = NULL;
+  char * fields[5];
+  int count = 0;
+  int ret = 0;
+  char * end;
+
+  memset(layout, 0, sizeof(array_layout_t));
+  for(char * item = strtok_r(copy, ":", & saveptr); item; item = strtok_r(NULL, ":", & saveptr)){
+    if(count == 5){
+      free(copy);
+      return -1;
+    }
+    fields[count++] = item;
+  }
+  if(count < 3){
+    free(copy);
+    return -1;
+  }
+  layout->ndims = strtol(fields[0], & end, 10);
+  if(layout->ndims < 1 || layout->ndims > ARRAY_LAYOUT_MAX_DIMS || strcasecmp(end, "d") != 0
+     || array_layout_parse_extents(layout->dims, layout->ndims, fields[1]) != 0
+     || array_layout_parse_extents(layout->grid, layout->ndims, fields[2]) != 0){
+    free(copy);
+    return -1;
+  }
+  layout->element_size = 8;
+  if(count > 3){
+    int64_t size = string_to_bytes(fields[3]);
+    if(size <= 0){
+      ret = -1;
+    }
+    layout->element_size = size;
+  }
+  for(int d = 0; d < layout->ndims; d++){
+    layout->local[d] = layout->dims[d] / layout->grid[d];
+    layout->block[d] = layout->local[d];
+  }
+  if(count > 4 && array_layout_parse_extents(layout->block, layout->ndims, fields[4]) != 0){
+    ret = -1;
+  }
+  free(copy);
+  for(int d = 0; d < layout->ndims; d++){
+    if(layout->dims[d] % (layout->grid[d] * layout->block[d]) != 0){
+      return -1;
+    }
+  }
+  return ret;
+}
+
+uint64_t array_layout_processes(const array_layout_t * layout){
+  uint64_t count = 1;
+  for(int d = 0; d < layout->ndims; d++){
+    count *= layout->grid[d];
+  }
+  return count;
+}
+
+uint64_t array_layout_local_size(const array_layout_t * layout){
+  uint64_t size = layout->element_size;
+  for(int d = 0; d < layout->ndims; d++){
+    size *= layout->local[d];
+  }
+  return size;
+}
+
+uint64_t array_layout_run_size(const array_layout_t * layout){
+  uint64_t size = layout->element_size;
+  for(int d = layout->ndims - 1; d >= 0; d--){
+    if(layout->grid[d] > 1){
+      /* a run ends at the first dimension that is split across processes */
+      return size * layout->block[d];
+    }
+    size *= layout->dims[d];
+  }
+  return size;
+}
+
+uint64_t array_layout_offset(const array_layout_t * layout, uint64_t rank, uint64_t offset){
+  uint64_t element = offset / layout->element_size;
+  uint64_t global[ARRAY_LAYOUT_MAX_DIMS];
+
+  for(int d = layout->ndims - 1; d >= 0; d--){
+    uint64_t coord = rank % layout->grid[d];
+    uint64_t index = element % layout->local[d];
+    uint64_t block = layout->block[d];
+    global[d] = index / block * block * layout->grid[d] + coord * block + index % block;
+    rank /= layout->grid[d];
+    element /= layout->local[d];
+  }
+  uint64_t pos = 0;
+  for(int d = 0; d < layout->ndims; d++){
+    pos = pos * layout->dims[d] + global[d];
+  }
+  return pos * layout->element_size + offset % layout->element_size;
+}
+
 /*
  * Free a buffer allocated by aligned_buffer_alloc().
  */
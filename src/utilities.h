@@ -24,6 +24,7 @@ extern int verbose;
 extern MPI_Comm testComm;
 extern FILE * out_resultfile;
 extern enum OutputFormat_t outputFormat;  /* format of the output */
+extern int timerTSC;
 
 /*
  * Try using the system's PATH_MAX, which is what realpath and such use.
@@ -35,7 +36,9 @@ extern enum OutputFormat_t outputFormat;  /* format of the output */
 void* safeMalloc(uint64_t size);
 void set_o_direct_flag(int *fd);
 
-ior_dataPacketType_e parsePacketType(char t);
+ior_dataPacketType_e parsePacketType(const char * type, double * dedupeCompress, double * dedupeFraction);
+/* set the compression ratio and fraction of duplicated blocks used for DATA_DEDUPE */
+void set_dedupe_pattern(double compress, double fraction);
 void update_write_memory_pattern(uint64_t item, char * buf, size_t bytes, int rand_seed, int rank, ior_dataPacketType_e dataPacketType, ior_memory_flags type);
 void update_write_memory_pattern_gpu(uint64_t item, char * buf, size_t bytes, int rand_seed, int rank, ior_dataPacketType_e dataPacketType);
 void generate_memory_pattern(char * buf, size_t bytes, int rand_seed, int rank, ior_dataPacketType_e dataPacketType, ior_memory_flags type);
@@ -70,14 +73,138 @@ void OpTimerValue(OpTimer* otimer_in, double now, double runTime);
 void OpTimerFlush(OpTimer* otimer_in);
 void OpTimerFree(OpTimer** otimer_in);
 
+/* Log-linear histogram of operation runtimes with a relative error below 1/128 */
+typedef struct LatencyHistogram LatencyHistogram;
+LatencyHistogram* LatencyHistogramInit(void);
+void LatencyHistogramValue(LatencyHistogram* histogram, double runTime);
+void LatencyHistogramMerge(LatencyHistogram* histogram, const LatencyHistogram* other);
+/* Merge the histograms of all processes, returns the result on root and NULL on the others */
+LatencyHistogram* LatencyHistogramReduce(const LatencyHistogram* histogram, int root, MPI_Comm com);
+/* Returns the runtime below which the given fraction of operations is, 1.0 returns the maximum */
+double LatencyHistogramPercentile(const LatencyHistogram* histogram, double fraction);
+uint64_t LatencyHistogramCount(const LatencyHistogram* histogram);
+void LatencyHistogramFree(LatencyHistogram** histogram);
+
+/* Bytes and operations completed per time interval since origin */
+typedef struct IntervalSamples IntervalSamples;
+IntervalSamples* IntervalSamplesInit(double origin, double interval);
+void IntervalSamplesValue(IntervalSamples* samples, double time, uint64_t bytes);
+void IntervalSamplesMerge(IntervalSamples* samples, const IntervalSamples* other);
+/* Sum the samples of all processes, collective, returns the result on root and NULL on the others */
+IntervalSamples* IntervalSamplesReduce(const IntervalSamples* samples, int root, MPI_Comm com);
+int IntervalSamplesCount(const IntervalSamples* samples);
+/* Returns the start of the interval relative to the origin, its duration which is shorter for the last one, bytes and operations */
+void IntervalSamplesGet(const IntervalSamples* samples, int interval, double * start, double * duration, uint64_t * bytes, uint64_t * ops);
+void IntervalSamplesFree(IntervalSamples** samples);
+
+/* HyperLogLog estimate of the number of distinct items with a standard error of 1.6% */
+typedef struct UniqueCounter UniqueCounter;
+UniqueCounter* UniqueCounterInit(void);
+void UniqueCounterValue(UniqueCounter* counter, uint64_t item);
+void UniqueCounterMerge(UniqueCounter* counter, const UniqueCounter* other);
+/* Merge the counters of all processes, returns the result on root and NULL on the others */
+UniqueCounter* UniqueCounterReduce(const UniqueCounter* counter, int root, MPI_Comm com);
+double UniqueCounterEstimate(const UniqueCounter* counter);
+void UniqueCounterFree(UniqueCounter** counter);
+
 /* Returns -1, if cannot be read  */
 int64_t ReadStoneWallingIterations(char * const filename, MPI_Comm com);
 void StoreStoneWallingIterations(char * const filename, int64_t count);
 
+/* synchronize the clocks of all processes, collective */
 void init_clock(MPI_Comm com);
 double GetTimeStamp(void);
+/* maximum correction of a clock to the one of rank 0 and the maximum error of the corrected clocks in s */
+void GetClockOffset(double * max_offset, double * error);
+char * GetClockSource(void);
 char * PrintTimestamp(void); // TODO remove this function
 unsigned long GetProcessorAndCore(int *chip, int *core);
+/*
+ * Seeded bijection of [0, count) that computes the i-th element on demand,
+ * a Feistel network over the next power of four with cycle walking.
+ */
+typedef struct {
+  uint64_t count;
+  uint64_t key;
+  int half_bits;
+  uint64_t half_mask;
+} random_permutation_t;
+
+void random_permutation_init(random_permutation_t * perm, uint64_t count, uint64_t seed);
+uint64_t random_permutation_get(const random_permutation_t * perm, uint64_t index);
+
+typedef enum {
+  DISTRIBUTION_UNIFORM,
+  DISTRIBUTION_ZIPF,
+  DISTRIBUTION_HOTSPOT,
+  DISTRIBUTION_PARETO
+} skewed_distribution_e;
+
+/*
+ * Distribution of ranks in [0, count) with rank 0 being the most frequent,
+ * the i-th draw is computed on demand from the seed and i.
+ */
+typedef struct {
+  skewed_distribution_e type;
+  double param[2];                 /* zipf: exponent, hotspot: percent of data and of accesses, pareto: fraction of hot data */
+  uint64_t count;
+  uint64_t key;
+  double h_integral_x1;            /* constants of the Zipf sampler */
+  double h_integral_n;
+  double s;
+} skewed_distribution_t;
+
+/* Parses "uniform", "zipf:E", "hotspot:D/A" or "pareto[:H]", returns 0 on success */
+int skewed_distribution_parse(skewed_distribution_t * dist, const char * str);
+void skewed_distribution_init(skewed_distribution_t * dist, uint64_t count, uint64_t seed);
+uint64_t skewed_distribution_get(const skewed_distribution_t * dist, uint64_t index);
+
+#define SIZE_DISTRIBUTION_MAX 16
+
+/*
+ * Distribution of transfer sizes, either a list of sizes with weights or a
+ * log-uniform range, all sizes are multiples of the smallest size min.
+ */
+typedef struct {
+  int count;                       /* number of sizes of the list, 0 for a range */
+  uint64_t size[SIZE_DISTRIBUTION_MAX];
+  double weight[SIZE_DISTRIBUTION_MAX]; /* cumulative probability of size[0..i] */
+  uint64_t min;
+  uint64_t max;
+} size_distribution_t;
+
+/* Parses "S[:W]+S[:W]+..." or "MIN-MAX", returns 0 on success */
+int size_distribution_parse(size_distribution_t * dist, const char * str);
+/* Returns the size for the uniform number u in [0, 1) */
+uint64_t size_distribution_get(const size_distribution_t * dist, double u);
+
+#define ARRAY_LAYOUT_MAX_DIMS 8
+
+/*
+ * Block-cyclic decomposition of a global N-d array stored in row-major order,
+ * dimension d is dealt in blocks of block[d] elements to the grid[d]
+ * processes of that dimension.  The processes are ordered row-major in the
+ * grid and every process stores its sub-array row-major.
+ */
+typedef struct array_layout {
+  int ndims;
+  uint64_t dims[ARRAY_LAYOUT_MAX_DIMS];
+  uint64_t grid[ARRAY_LAYOUT_MAX_DIMS];
+  uint64_t block[ARRAY_LAYOUT_MAX_DIMS];
+  uint64_t local[ARRAY_LAYOUT_MAX_DIMS]; /* elements of the sub-array */
+  uint64_t element_size;
+} array_layout_t;
+
+/* Parses "Nd:DIMS:GRID[:ELEMENTSIZE[:BLOCKS]]" with extents separated by x, returns 0 on success */
+int array_layout_parse(array_layout_t * layout, const char * str);
+uint64_t array_layout_processes(const array_layout_t * layout);
+/* Bytes of the sub-array of a process */
+uint64_t array_layout_local_size(const array_layout_t * layout);
+/* Bytes of the longest runs of a sub-array that are contiguous in the global array */
+uint64_t array_layout_run_size(const array_layout_t * layout);
+/* Returns the offset in the global array of the byte at offset in the sub-array of rank */
+uint64_t array_layout_offset(const array_layout_t * layout, uint64_t rank, uint64_t offset);
+
 void *aligned_buffer_alloc(size_t size, ior_memory_flags type);
 void aligned_buffer_free(void *buf, ior_memory_flags type);
 #endif  /* !_UTILITIES_H */
@@ -31,6 +31,33 @@ IOR 3 -a POSIX -w    -z  -Z -Q 1 -X -13 -F    -e -i1 -m -t 100k -b 200k
 
 IOR 2 -f "$ROOT/test_comments.ior"
 
+IOR 2 -a DUMMY -w -r -O queueDepth=4 --dummy.delay-xfer=100 -i1 -t 100k -b 200k
+IOR 2 -a POSIX -w -r -R -W -O threadsPerRank=3 -i1 -t 16k -b 1m -s 2
+IOR 2 -a DUMMY -w -r -O timer=TSC -i1 -t 100k -b 200k
+IOR 2 -a POSIX -w -r -O sampleInterval=0.001 -O threadsPerRank=2 -i1 -t 16k -b 1m
+IOR 2 -a POSIX -w -r -O targetIOPS=5000 -O targetArrivals=poisson -i1 -t 16k -b 1m
+IOR 2 -a POSIX -w -r -R -O rwmix=70 -z --random-offset-seed=7 -i2 -t 16k -b 1m -s 2
+IOR 2 -a POSIX -w -r -R -F -z --random-offset-seed=7 -O offsetDistribution=zipf:0.99 -i1 -t 16k -b 1m -s 2
+IOR 2 -a POSIX -w -r -z -O offsetDistribution=hotspot:10/90 -O rwmix=50 -i1 -t 16k -b 1m
+IOR 2 -a POSIX -w -r -C -W -R -O transferSizes=4k:3+64k:1 -i1 -b 1m -s 2
+IOR 2 -a POSIX -w -r -R -z --random-offset-seed=7 -O transferSizes=4k-256k -O threadsPerRank=2 -i1 -b 1m -s 2
+IOR 2 -a POSIX -w -r -W -R -O extentSize=4k -O fileHole=1k -O memoryHole=512 -i1 -t 64k -b 1m -s 2
+IOR 2 -a MPIIO -c -w -r -R -O extentSize=4k -O fileHole=4k -i1 -t 64k -b 1m
+IOR 2 -a POSIX -w -r -W -R -C -O layout=3d:64x32x16:1x2x1 -i1 -t 16k -s 2
+IOR 4 -a MPIIO -c -w -r -R -O layout=2d:256x256:2x2:8:16x32 -i1 -t 8k
+IOR 4 -a POSIX -w -r -W -R -C -O ranksPerFile=2 -i1 -t 16k -b 256k -s 2
+IOR 4 -a MPIIO -c -w -r -R -Z -O ranksPerFile=2 -i1 -t 16k -b 256k
+IOR 2 -a MPIIO -c -w -r -D 1 -O stoneWallingWearOut=1 -O stoneWallingAgreementInterval=8 -i1 -t 4k -b 4m
+IOR 2 -a POSIX -w -r -W -R -C -O verifyThreads=2 -i1 -t 64k -b 2m -s 2
+IOR 2 -a POSIX -w -r -W -R --posix.engine=seek -O threadsPerRank=2 -i1 -t 16k -b 1m -s 2
+IOR 2 -a POSIX -w -r -R --posix.engine=preadv2 --posix.nowait --posix.dsync -i1 -t 16k -b 1m
+IOR 2 -a POSIX -w -r -W -R -F -O cacheControl=fadvise+syncfs -O cacheResidency=1 -i1 -t 16k -b 1m
+IOR 2 -a POSIX -w -r -W -R --posix.fadvise=auto --posix.readahead=4 -i1 -t 16k -b 1m -s 2
+IOR 2 -a POSIX -w -r -W -R --posix.prealloc=fallocate -i1 -t 16k -b 1m -s 2
+IOR 2 -a POSIX -w -r -F --posix.sparse -i1 -t 16k -b 1m
+IOR 2 -a MMAP -w -r -W -R --mmap.window=256k --mmap.populate -O threadsPerRank=2 -i1 -t 16k -b 1m -s 2
+IOR 2 -a POSIX -w -r -R -W -l dedupe:compress=2.0:dedupe=0.3 -i1 -t 64k -b 256k
+
 # Test for JSON output
 IOR 2 -a DUMMY -e -F -t 1m -b 1m -A 328883 -O summaryFormat=JSON -O summaryFile=OUT.json
 python -mjson.tool OUT.json >/dev/null  && echo "JSON OK"